@@ -1,5 +1,6 @@
 #pragma once
 
+#include "animation_id.h"
 #include "frame.h"
 #include <core/config.h>
 #include <core/enums.h>
@@ -7,6 +8,7 @@
 
 struct Animation {
   std::string name;
+  AnimationId id = StringInterner::INVALID_ID;
   std::vector<Frame> frames;
   Animation *next_animation;
   AnimationDirection direction;
@@ -35,5 +37,39 @@ struct Animation {
 
   Animation(const std::string &name,
             AnimationDirection direction = AnimationDirection::LOOP)
-      : name(name), next_animation(nullptr), direction(direction) {}
+      : name(name), id(AnimationIds::intern(name)), next_animation(nullptr),
+        direction(direction) {}
+};
+
+// animations of a single sprite kind, indexed by their interned name
+class AnimationSet {
+public:
+  void add(Animation animation) {
+    animation.id = AnimationIds::intern(animation.name);
+    AnimationId id = animation.id;
+    _animations[id] = std::move(animation);
+  }
+
+  const Animation *find(AnimationId id) const {
+    auto it = _animations.find(id);
+    return it != _animations.end() ? &it->second : nullptr;
+  }
+
+  const Animation *find(const std::string &name) const {
+    AnimationId id = AnimationIds::find(name);
+    return id != StringInterner::INVALID_ID ? find(id) : nullptr;
+  }
+
+  bool contains(AnimationId id) const { return find(id) != nullptr; }
+  size_t size() const { return _animations.size(); }
+  bool empty() const { return _animations.empty(); }
+
+  auto begin() const { return _animations.begin(); }
+  auto end() const { return _animations.end(); }
+  // for the loaders, before the set is shared
+  auto begin() { return _animations.begin(); }
+  auto end() { return _animations.end(); }
+
+private:
+  std::unordered_map<AnimationId, Animation> _animations;
 };
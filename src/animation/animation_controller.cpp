@@ -1,75 +1,129 @@
 #include "animation_controller.h"
 #include <managers/logger/logger_manager.h>
 
-AnimationController::AnimationController()
-    : _current_frame_index(0), _timer(0) {}
-
 void AnimationController::add_animation(const std::string &name,
                                         const Animation &animation) {
-  _animations[name] = animation;
+  AnimationId current_animation = get_current_animation_id();
+
+  // copy on write, the current set may be shared with other controllers
+  auto animations = _animations != nullptr
+                        ? std::make_shared<AnimationSet>(*_animations)
+                        : std::make_shared<AnimationSet>();
+  Animation new_animation = animation;
+  new_animation.name = name;
+  animations->add(std::move(new_animation));
+  _animations = animations;
+
+  // the copy moved every clip, point the cursor at the new one
+  _cursor.clip = find_animation(current_animation);
+}
+
+void AnimationController::set_animations(
+    std::shared_ptr<const AnimationSet> animations) {
+  AnimationId current_animation = get_current_animation_id();
+
+  _animations = std::move(animations);
+
+  const Animation *clip = find_animation(current_animation);
+  if (clip == nullptr) {
+    _cursor.reset(nullptr);
+  } else {
+    _cursor.clip = clip;
+  }
 }
 
 void AnimationController::play_animation(const std::string &name) {
-  if (name == _current_animation ||
-      _animations.find(name) == _animations.end()) {
+  play_animation(AnimationIds::find(name));
+}
+
+void AnimationController::play_animation(AnimationId id) {
+  if (_cursor.clip != nullptr && _cursor.clip->id == id) {
     return;
   }
 
-  _current_animation = name;
-  _current_frame_index = 0;
-  _timer = 0;
-}
+  const Animation *clip = find_animation(id);
+  if (clip == nullptr) {
+    return;
+  }
 
-Frame AnimationController::get_current_frame() const {
-  const Animation &animation = _animations.at(_current_animation);
-  return animation.frames[_current_frame_index];
+  _cursor.reset(clip);
 }
 
 void AnimationController::update(double delta_time) {
-  delta_time *= 1000; // convert to milliseconds to match the timer time unit
+  advance(_cursor, delta_time);
+}
 
-  if (!_is_playing || _current_animation == "" ||
-      _animations.find(_current_animation) == _animations.end()) {
+void AnimationController::advance(AnimationCursor &cursor, double delta_time) {
+  if (!cursor.playing || !cursor.has_clip()) {
     return;
   }
 
-  const Animation &animation = _animations.at(_current_animation);
-  _timer += delta_time;
+  const Animation &animation = *cursor.clip;
+  size_t frame_count = animation.frames.size();
+
+  // convert to milliseconds to match the frame duration unit
+  cursor.timer += delta_time * 1000;
+
+  // a looping clip lagging behind by whole cycles (e.g. a sprite that was
+  // off-screen for a while) only needs to catch up on the remainder
+  if (animation.direction == AnimationDirection::LOOP &&
+      cursor.timer > animation.frames[cursor.frame_index].duration) {
+    int cycle_duration = 0;
+    for (const Frame &frame : animation.frames) {
+      cycle_duration += frame.duration;
+    }
+    if (cycle_duration > 0 && cursor.timer >= cycle_duration) {
+      cursor.timer = std::fmod(cursor.timer, cycle_duration);
+    }
+  }
+
+  // step as many frames as the elapsed time covers
+  while (cursor.timer >= animation.frames[cursor.frame_index].duration) {
+    int duration = animation.frames[cursor.frame_index].duration;
+    cursor.timer = duration > 0 ? cursor.timer - duration : 0;
 
-  if (_timer >= animation.frames[_current_frame_index].duration) {
-    _timer = 0;
-    _current_frame_index++;
+    size_t frame_index = cursor.frame_index + 1;
 
-    if (_current_frame_index < animation.frames.size() &&
-        animation.frames[_current_frame_index].callback != nullptr) {
-      animation.frames[_current_frame_index].callback();
+    if (frame_index < frame_count &&
+        animation.frames[frame_index].callback != nullptr) {
+      animation.frames[frame_index].callback();
     }
 
+    bool reached_end = frame_index >= frame_count;
+
     switch (animation.direction) {
     case AnimationDirection::FORWARD:
-      if (_current_frame_index >= animation.frames.size()) {
-        _current_frame_index = animation.frames.size() - 1;
+      if (reached_end) {
+        frame_index = frame_count - 1;
       }
       break;
     case AnimationDirection::REVERSE:
-      if (_current_frame_index >= animation.frames.size()) {
-        _current_frame_index = animation.frames.size() - 1;
+      if (reached_end) {
+        frame_index = frame_count - 1;
       }
       break;
     case AnimationDirection::LOOP:
-      if (_current_frame_index >= animation.frames.size()) {
-        _current_frame_index = 0;
+      if (reached_end) {
+        frame_index = 0;
+        reached_end = false;
       }
       break;
     case AnimationDirection::PING_PONG:
-      if (_current_frame_index >= animation.frames.size()) {
-        _current_frame_index =
-            animation.frames.size() - 1; // not working, useless anyway
+      if (reached_end) {
+        frame_index = frame_count - 1; // not working, useless anyway
       }
       break;
     default:
       break;
     }
+
+    cursor.frame_index = frame_index;
+
+    // a clip stuck on its last frame or with empty frames would spin forever
+    if (reached_end || duration <= 0) {
+      cursor.timer = 0;
+      break;
+    }
   }
 }
 
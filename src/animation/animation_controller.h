@@ -1,58 +1,98 @@
 #pragma once
 
 #include "animation.h"
+#include "animation_cursor.h"
 #include <core/config.h>
 
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Plays animations from a shared AnimationSet. The set itself is never
+ * copied, a controller only owns a handle to it and its playback cursor so it
+ * can be copied freely between sprites.
+ */
 class AnimationController {
 public:
-  AnimationController();
+  AnimationController() = default;
 
   void add_animation(const std::string &name, const Animation &animation);
   void play_animation(const std::string &name);
-  Frame get_current_frame() const;
+  void play_animation(AnimationId id);
 
   void update(double delta_time);
 
-  bool is_playing() const { return _is_playing; }
-  void resume() { _is_playing = true; }
-  void pause() { _is_playing = false; }
+  /**
+   * Advance a cursor by the given time, calling the frame callbacks of the
+   * clip on the way.
+   * @param cursor The cursor to advance.
+   * @param delta_time The elapsed time in seconds.
+   */
+  static void advance(AnimationCursor &cursor, double delta_time);
+
+  bool is_playing() const { return _cursor.playing; }
+  void resume() { _cursor.playing = true; }
+  void pause() { _cursor.playing = false; }
 
   void load_from_file(const std::string &file_path,
                       SupportedSerializer serializer);
 
   bool has_animation(const std::string &name) const {
-    return _animations.find(name) != _animations.end();
+    return find_animation(name) != nullptr;
+  }
+  bool has_animation(AnimationId id) const {
+    return find_animation(id) != nullptr;
+  }
+
+  const Animation *find_animation(const std::string &name) const {
+    return _animations != nullptr ? _animations->find(name) : nullptr;
+  }
+  const Animation *find_animation(AnimationId id) const {
+    return _animations != nullptr ? _animations->find(id) : nullptr;
   }
 
+  // the set is shared with every other controller using the same animations
+  const std::shared_ptr<const AnimationSet> &get_animations() const {
+    return _animations;
+  }
+  void set_animations(std::shared_ptr<const AnimationSet> animations);
+
   // getters and setters
-  std::string get_current_animation() const { return _current_animation; }
+  const std::string &get_current_animation() const {
+    static const std::string none;
+    return _cursor.clip != nullptr ? _cursor.clip->name : none;
+  }
+  AnimationId get_current_animation_id() const {
+    return _cursor.clip != nullptr ? _cursor.clip->id
+                                   : StringInterner::INVALID_ID;
+  }
 
-  const Frame &get_current_frame() {
-    if (_current_animation == "" ||
-        _animations.find(_current_animation) == _animations.end()) {
+  const Frame &get_current_frame() const {
+    if (!_cursor.has_clip()) {
       throw std::runtime_error("AnimationController::get_current_frame() - "
                                "current animation is not set");
     }
-    const Animation &animation = _animations.at(_current_animation);
 
-    if (_current_frame_index >= animation.frames.size()) {
+    if (_cursor.frame_index >= _cursor.clip->frames.size()) {
       throw std::runtime_error("AnimationController::get_current_frame() - "
                                "current frame index is out of range");
     }
-    return animation.frames[_current_frame_index];
+    return _cursor.get_frame();
   }
-  size_t get_current_frame_index() const { return _current_frame_index; }
+  size_t get_current_frame_index() const { return _cursor.frame_index; }
+  // clamped to the current clip, the cursor stores 16 bits
   void set_current_frame_index(size_t current_frame_index) {
-    _current_frame_index = current_frame_index;
+    size_t last = _cursor.has_clip() ? _cursor.clip->frames.size() - 1 : 0;
+    _cursor.frame_index = static_cast<uint16_t>(
+        std::min({current_frame_index, last, size_t{UINT16_MAX}}));
   }
 
-  int get_current_frame_count() const { return _timer; }
+  int get_current_frame_count() const { return _cursor.timer; }
 
-private:
-  bool _is_playing = true;
+  const AnimationCursor &get_cursor() const { return _cursor; }
+  AnimationCursor &get_cursor() { return _cursor; }
 
-  std::map<std::string, Animation> _animations;
-  std::string _current_animation;
-  size_t _current_frame_index;
-  int _timer;
+private:
+  std::shared_ptr<const AnimationSet> _animations = nullptr;
+  AnimationCursor _cursor;
 };
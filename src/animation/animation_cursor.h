@@ -0,0 +1,21 @@
+#pragma once
+
+#include "animation.h"
+
+// Per-instance playback state over a shared, read-only animation clip.
+struct AnimationCursor {
+  const Animation *clip = nullptr;
+  uint16_t frame_index = 0;
+  bool playing = true;
+  float timer = 0; // in milliseconds
+
+  bool has_clip() const { return clip != nullptr && !clip->frames.empty(); }
+
+  const Frame &get_frame() const { return clip->frames[frame_index]; }
+
+  void reset(const Animation *new_clip) {
+    clip = new_clip;
+    frame_index = 0;
+    timer = 0;
+  }
+};
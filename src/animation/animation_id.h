@@ -0,0 +1,28 @@
+#pragma once
+
+#include <structs/string_interner.h>
+
+using AnimationId = StringInterner::Id;
+
+// Animation names are interned once at load time, the per-frame code only
+// deals with the resulting integer ids.
+namespace AnimationIds {
+
+inline StringInterner &get_interner() {
+  static StringInterner interner;
+  return interner;
+}
+
+inline AnimationId intern(const std::string &name) {
+  return get_interner().intern(name);
+}
+
+inline AnimationId find(const std::string &name) {
+  return get_interner().find(name);
+}
+
+inline const std::string &get_name(AnimationId id) {
+  return get_interner().lookup(id);
+}
+
+} // namespace AnimationIds
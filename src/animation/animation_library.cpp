@@ -0,0 +1,126 @@
+#include "animation_library.h"
+#include "serializer.h"
+#include <managers/logger/logger_manager.h>
+#include <render/texture_atlas.h>
+
+std::shared_ptr<const AnimationSet>
+AnimationLibrary::load(const std::string &json_file_path,
+                       const std::string &key) {
+  auto &library = *AnimationLibrary::get();
+
+  if (!is_loaded(json_file_path) && !library.load_file(json_file_path)) {
+    return nullptr;
+  }
+
+  auto it = library._sets.find(make_key(json_file_path, key));
+
+  if (it == library._sets.end()) {
+    LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
+                             ": missing \"" +
+                             (key.empty() ? "animations" : key) + "\" key");
+    return nullptr;
+  }
+
+  return it->second;
+}
+
+std::shared_ptr<const AnimationSet>
+AnimationLibrary::add(const std::string &name, AnimationSet animations,
+                      const std::string &texture_name) {
+  auto &sets = AnimationLibrary::get()->_sets;
+  pack_frames(animations, texture_name);
+
+  auto set = std::make_shared<const AnimationSet>(std::move(animations));
+  sets[make_key("", name)] = set;
+
+  return set;
+}
+
+void AnimationLibrary::preload(const std::string &json_file_path) {
+  json json_data;
+  if (!AnimationSerializer::parse_file(json_file_path, json_data)) {
+    return;
+  }
+
+  auto &library = *AnimationLibrary::get();
+  std::lock_guard<std::mutex> lock(library._preload_mutex);
+  library._preloaded[json_file_path] = std::move(json_data);
+}
+
+bool AnimationLibrary::load_file(const std::string &json_file_path) {
+  json json_data;
+  {
+    std::lock_guard<std::mutex> lock(_preload_mutex);
+    auto preloaded = _preloaded.find(json_file_path);
+    if (preloaded != _preloaded.end()) {
+      json_data = std::move(preloaded->second);
+      _preloaded.erase(preloaded);
+    }
+  }
+
+  if (json_data.is_null() &&
+      !AnimationSerializer::parse_file(json_file_path, json_data)) {
+    return false;
+  }
+
+  _files.insert(json_file_path);
+
+  auto sheet = _sheets.find(json_file_path);
+  const std::string texture_name =
+      sheet != _sheets.end() ? sheet->second : std::string();
+
+  // build every set of the file now so the DOM can be dropped right away
+  for (auto &[key, value] : json_data.items()) {
+    if (key == "animations") {
+      AnimationSet animations;
+      AnimationSerializer::process_animations_json(value, animations,
+                                                   json_file_path);
+      pack_frames(animations, texture_name);
+      _sets[make_key(json_file_path, "")] =
+          std::make_shared<const AnimationSet>(std::move(animations));
+      continue;
+    }
+
+    if (!value.is_object() || value.find("animations") == value.end()) {
+      continue;
+    }
+
+    AnimationSet animations;
+    AnimationSerializer::process_animations_json(value["animations"],
+                                                 animations, json_file_path);
+    pack_frames(animations, texture_name);
+    _sets[make_key(json_file_path, key)] =
+        std::make_shared<const AnimationSet>(std::move(animations));
+  }
+
+  LoggerManager::log_info("Loaded animation file " + json_file_path);
+
+  return true;
+}
+
+void AnimationLibrary::pack_frames(AnimationSet &animations,
+                                   const std::string &texture_name) {
+  TextureAtlas &atlas = *TextureAtlas::get();
+  if (texture_name.empty() || !atlas.has_sheet(texture_name)) {
+    return;
+  }
+
+  for (auto &[id, animation] : animations) {
+    for (Frame &frame : animation.frames) {
+      AtlasRegion region;
+      if (atlas.pack(texture_name, frame.rect, region)) {
+        frame.rect = region.rect;
+        frame.texture = region.texture;
+        frame.trim = region.trim;
+      }
+    }
+  }
+}
+
+void AnimationLibrary::clean() {
+  _sets.clear();
+  _files.clear();
+
+  std::lock_guard<std::mutex> lock(_preload_mutex);
+  _preloaded.clear();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "animation.h"
+#include "serializer.h"
+#include <core/config.h>
+
+#include <mutex>
+
+/**
+ * Registry of immutable animation sets shared by every AnimationController.
+ * Each animation file is opened and parsed only once, the resulting sets are
+ * kept keyed by (file, key) and handed out as shared read-only pointers.
+ */
+class AnimationLibrary {
+public:
+  AnimationLibrary() = default;
+  ~AnimationLibrary() = default;
+
+  static AnimationLibrary *get() {
+    static std::unique_ptr<AnimationLibrary> instance =
+        std::make_unique<AnimationLibrary>();
+    return instance.get();
+  }
+
+  /**
+   * Get the animation set stored under `key` in the given file, parsing the
+   * file on first use.
+   * @param json_file_path The path of the animation file.
+   * @param key The top level key of the set, empty for a file that directly
+   * holds an "animations" array.
+   * @return The shared animation set.
+   */
+  static std::shared_ptr<const AnimationSet>
+  load(const std::string &json_file_path, const std::string &key = "");
+
+  /**
+   * Register an animation set built in code under the given name so that it
+   * can be shared like the ones loaded from files.
+   * @param texture_name The sheet the frames are cut from, they are packed
+   * into the TextureAtlas when it serves that sheet.
+   */
+  static std::shared_ptr<const AnimationSet>
+  add(const std::string &name, AnimationSet animations,
+      const std::string &texture_name = "");
+
+  /**
+   * Tell which sheet the frames of a file are cut from, they are packed into
+   * the TextureAtlas when the file is parsed if it serves that sheet. To call
+   * before the file is first loaded.
+   */
+  static void set_sheet(const std::string &json_file_path,
+                        const std::string &texture_name) {
+    get()->_sheets[json_file_path] = texture_name;
+  }
+
+  /**
+   * Read and parse a file ahead of its first load, which then only builds
+   * the sets. Safe from any thread, the slow part of loading a file does not
+   * touch the library.
+   */
+  static void preload(const std::string &json_file_path);
+
+  static bool is_loaded(const std::string &json_file_path) {
+    auto &files = get()->_files;
+    return files.find(json_file_path) != files.end();
+  }
+
+  void clean();
+
+private:
+  bool load_file(const std::string &json_file_path);
+  // point the frames to their atlas region, if the sheet is packed
+  static void pack_frames(AnimationSet &animations,
+                          const std::string &texture_name);
+
+  static std::string make_key(const std::string &json_file_path,
+                              const std::string &key) {
+    return json_file_path + '#' + key;
+  }
+
+  std::set<std::string> _files;
+  // file -> sheet its frames are cut from
+  std::map<std::string, std::string> _sheets;
+  std::map<std::string, std::shared_ptr<const AnimationSet>> _sets;
+
+  // parsed by preload(), waiting for their first load
+  std::mutex _preload_mutex;
+  std::map<std::string, json> _preloaded;
+};
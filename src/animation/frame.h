@@ -9,6 +9,13 @@ struct Frame {
   int duration;
   bool flipped;
 
+  // the atlas page the rect refers to once packed, null for the texture of
+  // the sprite
+  SDL_Texture *texture = nullptr;
+  // where the rect lies in the original frame once its transparent borders
+  // were trimmed, whose size is w x h, empty when not trimmed
+  SDL_Rect trim = {0, 0, 0, 0};
+
   // optional callback function
   std::function<void()> callback = nullptr;
 
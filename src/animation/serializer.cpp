@@ -1,23 +1,33 @@
 #include "serializer.h"
+#include "animation_library.h"
 #include <managers/logger/logger_manager.h>
 
 void AnimationSerializer::load_animations(AnimationController &controller,
                                           const std::string &json_file_path,
                                           const std::string &key) {
+  auto animations = AnimationLibrary::load(json_file_path, key);
+  if (animations == nullptr) {
+    return;
+  }
+
+  controller.set_animations(animations);
+}
+
+bool AnimationSerializer::parse_file(const std::string &json_file_path,
+                                     json &json_data) {
   std::ifstream file(json_file_path);
   if (!file.is_open()) {
     LoggerManager::log_fatal("Could not open file " + json_file_path);
-    return;
+    return false;
   }
 
-  json json_data;
   try {
     file >> json_data;
   } catch (const std::exception &e) {
     LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
                              ": " + e.what());
     file.close();
-    return;
+    return false;
   }
 
   file.close();
@@ -26,24 +36,15 @@ void AnimationSerializer::load_animations(AnimationController &controller,
     // Handle invalid JSON object error
     LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
                              ": invalid JSON object");
-    return;
+    return false;
   }
 
-  if (key.empty() && json_data.find("animations") == json_data.end()) {
-    // Handle missing "animations" key error
-    LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
-                             ": missing \"animations\" key");
-    return;
-  } else if (!key.empty() && json_data.find(key) == json_data.end()) {
-    // Handle missing key error
-    LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
-                             ": missing \"" + key + "\" key");
-    return;
-  }
-
-  const json &animations_json =
-      key.empty() ? json_data["animations"] : json_data[key]["animations"];
+  return true;
+}
 
+void AnimationSerializer::process_animations_json(
+    const json &animations_json, AnimationSet &animations,
+    const std::string &json_file_path) {
   if (!animations_json.is_array()) {
     // Handle invalid "animations" value error
     LoggerManager::log_fatal("Could not parse JSON file " + json_file_path +
@@ -62,18 +63,18 @@ void AnimationSerializer::load_animations(AnimationController &controller,
     if (animation_json.find("preset") != animation_json.end() &&
         animation_json["preset"].is_string()) {
       if (animation_json["preset"] == "walk") {
-        walk_preset(controller, animation_json);
+        walk_preset(animations, animation_json);
       }
 
       if (animation_json["preset"] == "idle_down") {
-        idle_down_preset(controller, animation_json);
+        idle_down_preset(animations, animation_json);
       }
       continue;
     }
 
     Animation new_animation;
     process_animation_json(animation_json, new_animation);
-    controller.add_animation(new_animation.name, new_animation);
+    animations.add(new_animation);
   }
 }
 
@@ -182,7 +183,7 @@ void AnimationSerializer::process_frame_json(const json &frame_json,
   }
 }
 
-void AnimationSerializer::walk_preset(AnimationController &controller,
+void AnimationSerializer::walk_preset(AnimationSet &animations,
                                       const json &animation_json) {
   std::vector<std::string> directions = {"up", "down", "left", "right"};
   Vector2i start = {animation_json["start"]["x"], animation_json["start"]["y"]};
@@ -201,7 +202,7 @@ void AnimationSerializer::walk_preset(AnimationController &controller,
         frame.duration = 100;
         frame.flipped = false;
         idle_animation.frames.push_back(frame);
-        controller.add_animation(idle_animation.name, idle_animation);
+        animations.add(idle_animation);
       }
 
       Frame frame;
@@ -209,12 +210,12 @@ void AnimationSerializer::walk_preset(AnimationController &controller,
       frame.duration = 100;
       frame.flipped = false;
       new_animation.frames.push_back(frame);
-      controller.add_animation(new_animation.name, new_animation);
+      animations.add(new_animation);
     }
   }
 }
 
-void AnimationSerializer::idle_down_preset(AnimationController &controller,
+void AnimationSerializer::idle_down_preset(AnimationSet &animations,
                                            const json &animation_json) {
   Vector2i start = {animation_json["start"]["x"], animation_json["start"]["y"]};
   Vector2i size = {animation_json["size"]["width"],
@@ -230,5 +231,5 @@ void AnimationSerializer::idle_down_preset(AnimationController &controller,
     frame.flipped = false;
     idle_animation.frames.push_back(frame);
   }
-  controller.add_animation(idle_animation.name, idle_animation);
+  animations.add(idle_animation);
 }
@@ -14,11 +14,14 @@ namespace AnimationSerializer {
 void load_animations(AnimationController &controller,
                      const std::string &json_file_path,
                      const std::string &key = "");
+bool parse_file(const std::string &json_file_path, json &json_data);
+void process_animations_json(const json &animations_json,
+                             AnimationSet &animations,
+                             const std::string &json_file_path);
 void process_animation_json(const json &animation_json, Animation &animation);
 void process_frame_json(const json &frame_json, Frame &frame);
 
-void walk_preset(AnimationController &controller, const json &animation_json);
-void idle_down_preset(AnimationController &controller,
-                      const json &animation_json);
+void walk_preset(AnimationSet &animations, const json &animation_json);
+void idle_down_preset(AnimationSet &animations, const json &animation_json);
 
-} // namespace AnimationSerializer
\ No newline at end of file
+} // namespace AnimationSerializer
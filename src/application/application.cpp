@@ -1,6 +1,11 @@
 #include "application.h"
+#include <animation/animation_library.h>
 #include <animation/serializer.h>
+#include <jobs/job_system.h>
+#include <jobs/task_graph.h>
 #include <managers/input/input_manager.h>
+#include <render/text_cache.h>
+#include <render/texture_atlas.h>
 #include <utils/render_utils.h>
 
 void Application::run() {
@@ -14,8 +19,7 @@ void Application::run() {
         app->on_frame_start();
         app->handle_events();
         app->handle_input();
-        app->update();
-        app->render();
+        app->_frame_pipeline.run_frame(app->_renderer.get());
       },
       app, 0, 1);
 #else
@@ -23,8 +27,9 @@ void Application::run() {
     app->on_frame_start();
     app->handle_events();
     app->handle_input();
-    app->update();
-    app->render();
+    // update and record the next frame while the last one is drawn
+    app->_frame_pipeline.run_frame(app->_renderer.get());
+    app->_frame_clock.wait_for_next_frame();
   }
 
   app->clean();
@@ -86,23 +91,95 @@ void Application::init() {
 
   LoggerManager::init();
 
+  // update the sprites in parallel, rendering stays on this thread
+  JobSystem::get()->start();
+  // one mapped file instead of the loose asset files, when packed
+  if (!AssetManager::get()->mount_pack(ApplicationConfig::asset_pack_path)) {
+    LoggerManager::log_info("No asset pack, loading the asset files");
+  }
+  if (_config->cache_decoded_textures) {
+    AssetManager::get()->set_texture_cache(ApplicationConfig::texture_cache_path);
+  }
+  // decode the images in the background, uploaded by on_frame_start()
+  AssetManager::get()->start_streaming();
+  AssetManager::get()->set_texture_budget(_config->texture_budget_mb * 1024 *
+                                          1024);
+
   // set initial state
   _is_running = true;
   _last_frame_ticks = SDL_GetTicks();
 
   adjust_window_scale();
-  init_map();
-  init_fonts();
-  init_trainer();
-  init_sprites();
+  SpriteStore::get()->set_cell_size(_config->window_config.tile_size);
+  init_content();
+
+  _frame_clock.set_step_rate(_config->simulation_hz);
+  _frame_clock.set_max_fps(_config->window_config.max_fps);
+  // the loading time is not simulated
+  _frame_clock.reset();
+
+  _frame_pipeline.start(
+      [this](DrawList &draw_list) {
+        update();
+        render(draw_list);
+      },
+      _config->threaded_rendering);
 
   LoggerManager::log_info("Application initialized");
 }
 
+void Application::init_content() {
+  // the files are read and parsed on workers, everything touching the
+  // renderer, the sprite store or the animation library stays on this thread
+  TaskGraph startup;
+
+  TaskGraph::TaskId map = startup.add("map", [this] { init_map(); });
+  startup.add(
+      "map textures",
+      [this] {
+        _map->load_textures();
+        _map_image =
+            AssetManager::request_texture("zoo.png", AssetDirectory::MAPS);
+        _path_queue.start();
+      },
+      {map}, TaskAffinity::MAIN);
+
+  startup.add("fonts", [this] { init_fonts(); });
+
+  TaskGraph::TaskId animations = startup.add("animations", [] {
+    AnimationLibrary::preload(
+        "../src/assets/animations/pokemons/bw_overworld.json");
+  });
+
+  TaskGraph::TaskId atlas =
+      startup.add("atlas", [this] { init_atlas(); }, {}, TaskAffinity::MAIN);
+  TaskGraph::TaskId sheets = startup.add(
+      "sheets", [] { TextureAtlas::get()->decode_sheets(); }, {atlas});
+
+  // the frames are packed into the atlas as the animations are loaded
+  TaskGraph::TaskId trainer =
+      startup.add("trainer", [this] { init_trainer(); }, {animations, sheets},
+                  TaskAffinity::MAIN);
+  TaskGraph::TaskId sprites =
+      startup.add("sprites", [this] { init_sprites(); }, {trainer},
+                  TaskAffinity::MAIN);
+
+  startup.add(
+      "release sheets",
+      // every animation is loaded, the decoded sheets are not needed anymore
+      [] { TextureAtlas::get()->release_sheets(); }, {sprites},
+      TaskAffinity::MAIN);
+
+  startup.run(_config->parallel_startup);
+  startup.log_report("Startup");
+}
+
 void Application::init_map() {
   LoggerManager::log_info("Initializing map");
   _map = std::make_unique<Map>();
-  _map->load("assets/maps/map1.json");
+  _map->set_chunk_caching(_config->cache_map_chunks);
+  // the tileset images are requested from the renderer thread
+  _map->load_data("zoo.tmx");
   LoggerManager::log_info("Initializing map done");
 }
 
@@ -112,13 +189,31 @@ void Application::init_fonts() {
   LoggerManager::log_info("Initializing fonts done");
 }
 
+void Application::init_atlas() {
+  AnimationLibrary::set_sheet(
+      "../src/assets/animations/pokemons/bw_overworld.json",
+      "bw_overworld.png");
+
+  if (!_config->pack_animation_atlas) {
+    return;
+  }
+
+  LoggerManager::log_info("Initializing atlas");
+  // the frames of these sheets are packed as their animations are loaded,
+  // the sprites using them draw from the atlas pages
+  TextureAtlas::get()->add_sheet("bw_overworld.png");
+  TextureAtlas::get()->add_sheet("pokemons_4th_gen.png");
+  LoggerManager::log_info("Initializing atlas done");
+}
+
 void Application::init_trainer() {
   LoggerManager::log_info("Initializing trainer");
 
-  Trainer trainer("bw_overworld.png", 0, 0, 32, 32);
-  trainer.set_name("Ash");
+  _trainer = std::make_unique<Trainer>("bw_overworld.png", 0, 0, 32, 32);
+  _trainer->set_name("Ash");
+  // draw the trainer on top of the other sprites
+  _trainer->set_z_index(1);
 
-  _trainer = std::make_unique<Trainer>(trainer);
   AnimationSerializer::load_animations(_trainer->get_animation_controller(),
                                        "../src/assets/animations/"
                                        "pokemons/bw_overworld.json",
@@ -138,12 +233,17 @@ void Application::init_sprites() {
   idle_up.add_frame(Frame({64, 0, 32, 32}, 100));
   idle_up.add_frame(Frame({96, 0, 32, 32}, 100));
 
-  animation_controller.add_animation("idle_up", idle_up);
+  AnimationSet pokemons_4th_gen_animations;
+  pokemons_4th_gen_animations.add(idle_up);
+  animation_controller.set_animations(
+      AnimationLibrary::add("pokemons_4th_gen",
+                            std::move(pokemons_4th_gen_animations),
+                            "pokemons_4th_gen.png"));
   animation_controller.play_animation("idle_up");
 
   new_sprite.attach_animation_controller(animation_controller);
 
-  _sprites.push_back(std::make_unique<Sprite>(new_sprite));
+  _sprites.push_back(std::make_unique<Sprite>(std::move(new_sprite)));
 
   Sprite kyurem("bw_overworld.png", 736, 1216, 128, 128);
   AnimationController kyurem_animation_controller;
@@ -155,13 +255,23 @@ void Application::init_sprites() {
   kyurem.attach_animation_controller(kyurem_animation_controller);
   kyurem.set_position(100, 100);
 
-  _sprites.push_back(std::make_unique<Sprite>(kyurem));
+  static const AnimationId walk_right = AnimationIds::intern("walk_right");
+
+  // the sprites that can walk wander to the right
+  if (kyurem.get_animation_controller().has_animation(walk_right)) {
+    kyurem.get_animation_controller().play_animation(walk_right);
+    kyurem.set_velocity({100, 0});
+  }
+
+  _sprites.push_back(std::make_unique<Sprite>(std::move(kyurem)));
 
   std::vector<std::string> pokemon_list = {
       "kyurem",    "pikachu",   "keldeo",    "boreas",   "fulguris",
       "demeteros", "cobaltium", "terrakium", "viridium", "victini",
       "munna",     "musharna",  "ratentif",  "zorua"};
 
+  // every sprite of the same kind shares the animation set parsed once by the
+  // library, the json file is only read on the first iteration
   for (int i = 0; i < 1000; ++i) {
     int x = rand() % 1000;
     int y = rand() % 1000;
@@ -172,16 +282,18 @@ void Application::init_sprites() {
       new_sprite.set_size(128, 128);
     }
 
-    AnimationController animation_controller;
-    AnimationSerializer::load_animations(
-        animation_controller,
+    new_sprite.attach_animations(AnimationLibrary::load(
         "../src/assets/animations/pokemons/bw_overworld.json",
-        pokemon_list[pokemon_index]);
-    animation_controller.play_animation("idle_down");
+        pokemon_list[pokemon_index]));
+    new_sprite.get_animation_controller().play_animation("idle_down");
 
-    new_sprite.attach_animation_controller(animation_controller);
+    // the sprites that can walk wander to the right
+    if (new_sprite.get_animation_controller().has_animation(walk_right)) {
+      new_sprite.get_animation_controller().play_animation(walk_right);
+      new_sprite.set_velocity({100, 0});
+    }
 
-    _sprites.push_back(std::make_unique<Sprite>(new_sprite));
+    _sprites.push_back(std::make_unique<Sprite>(std::move(new_sprite)));
   }
 
   LoggerManager::log_info("Initializing sprites done");
@@ -200,6 +312,9 @@ void Application::adjust_window_scale() {
       "Default window size: " + std::to_string(DEFAULT_WINDOW_WIDTH) + "x" +
       std::to_string(DEFAULT_WINDOW_HEIGHT));
 
+  // the camera works in logical pixels, not in physical ones
+  _camera.set_size(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
+
   if (_config->window_config.width != DEFAULT_WINDOW_WIDTH ||
       _config->window_config.height != DEFAULT_WINDOW_HEIGHT) {
     float width_scale =
@@ -221,98 +336,133 @@ void Application::adjust_window_scale() {
 }
 
 void Application::update() {
-  uint32_t current_frame_ticks = SDL_GetTicks();
-  _fps = 1000 / std::max((current_frame_ticks - _last_frame_ticks), 10u);
-  while (_fps > Application::get_config()->window_config.max_fps) {
-    _fps = 1000 / std::max(SDL_GetTicks() - _last_frame_ticks, 10u);
+  _last_frame_ticks = SDL_GetTicks();
+  _fps = static_cast<int>(_frame_clock.get_fps());
+  _delta_time = _frame_clock.get_step();
+
+  // answer the path queries of the previous frames and send the new ones
+  if (_map && _map->is_loaded()) {
+    _path_queue.set_grid(_map->get_nav_snapshot());
   }
-  _delta_time = (current_frame_ticks - _last_frame_ticks) / 1000.0f;
-  _last_frame_ticks = current_frame_ticks;
+  _path_queue.update();
 
-  // update instances
-  // _map->update(_delta_time);
+  for (int i = 0; i < _step_count; i++) {
+    step(_delta_time);
+    // a key press is seen by the first step only, and kept for the next
+    // frames until a step runs
+    InputManager::update_key_states();
+  }
+}
 
-  _delta_time = std::max(_delta_time, 0.0016);
+void Application::step(double delta_time) {
+  SpriteStore &sprite_store = *SpriteStore::get();
+  sprite_store.save_previous_positions();
 
   if (_trainer) {
-    _trainer->update(_delta_time);
+    _trainer->update(delta_time);
   }
 
-  // update sprites
-  for (auto &sprite : _sprites) {
+  // move and animate every sprite in a single pass over the store
+  sprite_store.update(delta_time,
+                      _config->lazy_offscreen_animations ? &_camera : nullptr);
 
-    if (sprite->get_animation_controller().has_animation("walk_right")) {
-      sprite->get_animation_controller().play_animation("walk_right");
-      sprite->move(100 * _delta_time, 0);
-    }
+  // wrap the sprites around the screen, the trainer is free to leave it
+  size_t trainer_index =
+      _trainer ? sprite_store.index_of(_trainer->get_handle()) : SIZE_MAX;
+  int max_x = _config->window_config.width / _config->window_config.scale.x;
+  auto &dest_rects = sprite_store.get_dest_rects();
+  auto &positions = sprite_store.get_positions();
 
-    if (sprite->get_dest_rect().x >
-        _config->window_config.width / _config->window_config.scale.x) {
-      sprite->set_position(0, sprite->get_dest_rect().y);
+  for (size_t i = 0; i < sprite_store.size(); i++) {
+    if (dest_rects[i].x > max_x && i != trainer_index) {
+      sprite_store.teleport(i, 0, positions[i].y);
     }
-
-    sprite->update(_delta_time);
   }
 }
 
-void Application::render() {
-  SDL_SetRenderDrawColor(_renderer.get(), 0, 0, 0, 255);
-  SDL_RenderClear(_renderer.get());
-
-  SDL_Texture *map_texture =
-      AssetManager::get_texture("zoo.png", AssetDirectory::MAPS);
-  // the map is the full size of the texture
+void Application::render(DrawList &draw_list) {
+  draw_list.clear({0, 0, 0, 255});
 
   int map_width = _config->window_config.width / _config->window_config.scale.x;
   int map_height =
       _config->window_config.height / _config->window_config.scale.y;
-  SDL_Rect map_rect = {
-      0,
-      0,
-      map_width,
-      map_height,
-  };
-  SDL_RenderCopy(_renderer.get(), map_texture, nullptr, &map_rect);
-
-  RenderUtils::render_grid(_renderer.get(), _config->window_config.width,
-                           _config->window_config.height,
-                           _config->window_config.tile_size,
-                           {255, 255, 255, 100});
-
-  for (auto &sprite : _sprites) {
-    sprite->render(_renderer.get());
-  }
+  Camera camera = _camera;
+
+  // the map bakes its chunks into render targets, it is drawn by the thread
+  // owning the renderer
+  draw_list.callback([this, camera, map_width,
+                      map_height](SDL_Renderer *renderer) {
+    if (_map) {
+      _map->update_textures();
+    }
+    if (_map && _map->is_renderable()) {
+      _map->render(renderer, camera);
+      return;
+    }
 
-  if (_trainer) {
-    _trainer->render(_renderer.get());
-  }
+    // fall back on the pre-rendered image of the map when its tilesets are
+    // not available, nothing is drawn while it streams in
+    SDL_Texture *map_texture = _map_image.get();
+    // the map is the full size of the texture
+    SDL_Rect map_rect = {
+        0,
+        0,
+        map_width,
+        map_height,
+    };
+    SDL_RenderCopy(renderer, map_texture, nullptr, &map_rect);
+  });
+
+  draw_list.grid(_config->window_config.width, _config->window_config.height,
+                 _config->window_config.tile_size, {255, 255, 255, 100});
+
+  // the trainer is part of the store, drawn last thanks to its z index
+  SpriteStore::get()->render(
+      draw_list, _camera,
+      _config->interpolate_rendering ? _frame_clock.get_alpha() : 1.f);
 
   Vector2i mouse_coords = Vector2i(InputManager::get_mouse_position()) /
                           _config->window_config.tile_size;
 
-  RenderUtils::render_rect(_renderer.get(),
-                           {mouse_coords.x * _config->window_config.tile_size,
-                            mouse_coords.y * _config->window_config.tile_size,
-                            _config->window_config.tile_size,
-                            _config->window_config.tile_size},
-                           {255, 0, 0, 100});
+  draw_list.rect({mouse_coords.x * _config->window_config.tile_size,
+                  mouse_coords.y * _config->window_config.tile_size,
+                  _config->window_config.tile_size,
+                  _config->window_config.tile_size},
+                 {255, 0, 0, 100});
+
+  // pick the sprites under the mouse through the spatial hash
+  _hovered_sprites.clear();
+  SpriteStore::get()->query_point(
+      _camera.screen_to_world(InputManager::get_mouse_position()),
+      _hovered_sprites);
 
   std::stringstream ss;
   ss << "Mouse: " << mouse_coords << '\n';
+  ss << "Hovered sprites: " << _hovered_sprites.size() << '\n';
   ss << "FPS: " << std::to_string(_fps) << '\n';
-  ss << "Delta time: " << std::to_string(_delta_time) << '\n'
+  // statistics of the previous frame, this one is not drawn yet
+  const DrawStats &draw_stats = _frame_pipeline.get_stats();
+  ss << "Sprites: " << draw_stats.sprite_count << " in "
+     << draw_stats.draw_call_count << " draw calls" << '\n';
+  ss << "Frame time: " << std::to_string(_frame_clock.get_frame_time())
+     << '\n';
+  AssetStats asset_stats = AssetManager::get()->get_stats();
+  ss << "Textures: " << asset_stats.texture_count << " ("
+     << asset_stats.texture_bytes / (1024 * 1024) << " MB)" << '\n';
+  ss << "Step: " << std::to_string(_delta_time) << '\n'
      << "Keyboard Direction: " << InputManager::get_directional_input() << '\n'
      << "Animation: "
      << _trainer->get_animation_controller().get_current_animation() << '\n';
 
-  RenderUtils::render_text(
-      _renderer.get(), AssetManager::get_font("Roboto/Roboto-Regular.ttf", 16),
-      ss.str().c_str(), {255, 255, 255, 255}, 0, 0, true);
-
-  SDL_RenderPresent(_renderer.get());
+  draw_list.text(AssetManager::get_font("Roboto/Roboto-Regular.ttf", 16),
+                 ss.str(), {255, 255, 255, 255}, 0, 0, true);
 }
 
-void Application::on_frame_start() { InputManager::update_key_states(); }
+void Application::on_frame_start() {
+  _step_count = _frame_clock.begin_frame();
+  // the frame pipeline is idle, the textures can be created
+  AssetManager::update(_config->asset_upload_budget_ms);
+}
 
 void Application::loop() {
   // same as run, for emscripten
@@ -324,8 +474,7 @@ void Application::loop() {
     Application *app = static_cast<Application *>(app_ptr);
     app->on_frame_start();
     app->handle_events();
-    app->update();
-    app->render();
+    app->_frame_pipeline.run_frame(app->_renderer.get());
     return 0;
   };
 
@@ -353,6 +502,12 @@ void Application::handle_events() {
         adjust_window_scale();
       }
       break;
+    case SDL_RENDER_TARGETS_RESET:
+      // the content of the render targets is gone, rebake the map chunks
+      if (_map) {
+        _map->invalidate_chunks();
+      }
+      break;
     default:
       break;
     }
@@ -362,6 +517,20 @@ void Application::handle_events() {
 void Application::handle_input() {}
 
 void Application::clean() {
+  _frame_pipeline.stop();
+  _path_queue.stop();
+  JobSystem::get()->stop();
+
+  // release the sprites before the stores they point into
+  _sprites.clear();
+  _trainer.reset();
+  SpriteStore::get()->clear();
+  AnimationLibrary::get()->clean();
+  // after the animations whose frames point into its pages
+  TextureAtlas::get()->clean();
+  TextCache::get()->clean();
+  AssetManager::get()->clean();
+
   SDL_Quit();
   TTF_Quit();
 
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <camera/camera.h>
 #include <core/config.h>
+#include <core/frame_clock.h>
 #include <managers/asset/asset_manager.h>
 #include <managers/logger/logger_manager.h>
 #include <map/map.h>
+#include <pathfinding/path_queue.h>
+#include <render/frame_pipeline.h>
 #include <sprite/sprite.h>
 #include <sprite/trainer.h>
 
@@ -13,6 +17,8 @@ public:
   ~Application() = default;
 
   static Application *get() {
+    // constructed first so that it outlives the sprites owned by the instance
+    [[maybe_unused]] static SpriteStore *sprite_store = SpriteStore::get();
     static std::unique_ptr<Application> instance =
         std::make_unique<Application>();
     return instance.get();
@@ -23,6 +29,7 @@ public:
 
   bool is_running() const { return _is_running; }
 
+  // duration of a simulation step, in seconds
   double get_delta_time() const { return _delta_time; }
   uint32_t get_last_frame_ticks() const { return _last_frame_ticks; }
 
@@ -37,10 +44,17 @@ public:
 
   void set_map(std::unique_ptr<Map> map) { _map = std::move(map); }
 
+  Camera &get_camera() { return _camera; }
+  // answers path queries off the main thread, see PathQueue
+  PathQueue &get_path_queue() { return _path_queue; }
+
 private:
   void init();
+  // load the map, fonts, sheets and sprites, overlapping what can be
+  void init_content();
   void init_map();
   void init_fonts();
+  void init_atlas();
   void init_trainer();
   void init_sprites();
 
@@ -48,8 +62,11 @@ private:
 
   void on_frame_start();
   void loop();
-  void render();
+  // record the draws of the frame, replayed later by the frame pipeline
+  void render(DrawList &draw_list);
   void update();
+  // advance the simulation by one fixed step
+  void step(double delta_time);
   void handle_events();
   void handle_input();
   void clean();
@@ -63,13 +80,22 @@ private:
   std::unique_ptr<ApplicationConfig> _config = nullptr;
 
   // instances
+  Camera _camera;
   std::unique_ptr<Map> _map = nullptr;
   std::vector<std::unique_ptr<Sprite>> _sprites;
   std::unique_ptr<Trainer> _trainer = nullptr;
+  std::vector<SpriteHandle> _hovered_sprites;
+  PathQueue _path_queue;
+  FrameClock _frame_clock;
+  FramePipeline _frame_pipeline;
+  // pre-rendered image of the map, drawn until its tilesets are loaded
+  TextureHandle _map_image;
 
   // states
   bool _is_running = false;
   double _delta_time = 0.0;
+  // simulation steps to run this frame
+  int _step_count = 0;
   int _fps = 0;
   uint32_t _last_frame_ticks = 0;
 };
@@ -0,0 +1,17 @@
+#include "camera.h"
+
+void Camera::center_on(const Vector2f &target, int world_width,
+                       int world_height) {
+  _position.x = target.x - _width / 2.f;
+  _position.y = target.y - _height / 2.f;
+
+  if (world_width > _width) {
+    _position.x = std::clamp(_position.x, 0.f,
+                             static_cast<float>(world_width - _width));
+  }
+
+  if (world_height > _height) {
+    _position.y = std::clamp(_position.y, 0.f,
+                             static_cast<float>(world_height - _height));
+  }
+}
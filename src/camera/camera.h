@@ -0,0 +1,60 @@
+#pragma once
+
+#include <core/config.h>
+#include <structs/my_vector.h>
+
+/**
+ * View over the world, in world pixels. Everything outside of the visible
+ * rect can be skipped before reaching SDL.
+ */
+class Camera {
+public:
+  Camera() = default;
+  Camera(int width, int height) : _width(width), _height(height) {}
+  ~Camera() = default;
+
+  void set_position(float x, float y) { _position = {x, y}; }
+  template <typename T> void set_position(const Vector2<T> &position) {
+    _position = position;
+  }
+
+  void set_size(int width, int height) {
+    _width = width;
+    _height = height;
+  }
+
+  // center the view on a world position, keeping it inside the given bounds
+  // when they are larger than the view
+  void center_on(const Vector2f &target, int world_width = 0,
+                 int world_height = 0);
+
+  const Vector2f &get_position() const { return _position; }
+  int get_width() const { return _width; }
+  int get_height() const { return _height; }
+
+  SDL_Rect get_visible_rect() const {
+    return {static_cast<int>(_position.x), static_cast<int>(_position.y),
+            _width, _height};
+  }
+
+  bool is_visible(const SDL_Rect &rect) const {
+    int left = static_cast<int>(_position.x);
+    int top = static_cast<int>(_position.y);
+    return rect.x + rect.w > left && rect.x < left + _width &&
+           rect.y + rect.h > top && rect.y < top + _height;
+  }
+
+  SDL_Rect world_to_screen(const SDL_Rect &rect) const {
+    return {rect.x - static_cast<int>(_position.x),
+            rect.y - static_cast<int>(_position.y), rect.w, rect.h};
+  }
+
+  Vector2f screen_to_world(const Vector2f &point) const {
+    return point + _position;
+  }
+
+private:
+  Vector2f _position = Vector2f::zero();
+  int _width = DEFAULT_WINDOW_WIDTH;
+  int _height = DEFAULT_WINDOW_HEIGHT;
+};
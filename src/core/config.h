@@ -61,12 +61,41 @@ struct ApplicationConfig {
   WindowConfig window_config;
   Version version = {0, 0, 1};
 
+  // do not advance the animations of off-screen sprites until they come back
+  // into view
+  bool lazy_offscreen_animations = true;
+  // draw the static map layers from pre-rendered chunk textures
+  bool cache_map_chunks = true;
+  // simulation steps per second, independent of the frame rate
+  uint16_t simulation_hz = 60;
+  // draw the sprites between their last two simulated positions
+  bool interpolate_rendering = true;
+  // simulate the next frame on a thread of its own while the last one is
+  // submitted to the renderer
+  bool threaded_rendering = true;
+  // pack the animation frames of the sprite sheets into shared atlas pages
+  bool pack_animation_atlas = true;
+  // decode the map images on streaming threads, uploading them for at most
+  // this long per frame, in milliseconds
+  double asset_upload_budget_ms = 2.0;
+  // texture memory kept once the textures are not used anymore, in
+  // megabytes
+  size_t texture_budget_mb = 256;
+  // keep the decoded images in texture_cache_path, skipping their decoding
+  // on the next runs
+  bool cache_decoded_textures = true;
+  // load the independent assets at the same time on startup
+  bool parallel_startup = true;
+
   inline static std::string font_path = "../src/assets/fonts/";
   inline static std::string map_path = "../src/assets/maps/";
   inline static std::string texture_path = "../src/assets/textures/";
   inline static std::string tileset_path = "../src/assets/tilesets/";
   inline static std::string animation_path = "../src/assets/animations/";
   inline static std::string audio_path = "../src/assets/audios/";
+  // read in place of the directories above when it exists
+  inline static std::string asset_pack_path = "../src/assets.pza";
+  inline static std::string texture_cache_path = "../src/assets/.texture_cache/";
 
   static std::string_view get_asset_path(AssetDirectory dir) {
     switch (dir) {
@@ -76,6 +105,8 @@ struct ApplicationConfig {
       return font_path;
     case AssetDirectory::MAPS:
       return map_path;
+    case AssetDirectory::TILESETS:
+      return tileset_path;
     case AssetDirectory::ANIMATIONS:
       return animation_path;
     case AssetDirectory::AUDIO:
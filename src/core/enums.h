@@ -1,14 +1,26 @@
 #pragma once
 
+#include <cstdint>
+
 // SPRITE
 enum class SupportedSerializer { JSON, XML, COUNT };
 
 // MAP
 enum LayerType { TILE_LAYER, OBJECT_LAYER, OBSTACLE_LAYER };
-enum class TileType { NONE, FLOOR, WALL, COUNT };
+enum class TileType : uint8_t { NONE, FLOOR, WALL, COUNT };
 
 // ASSET MANAGER
-enum class AssetDirectory { TEXTURES, FONTS, MAPS, ANIMATIONS, AUDIO, COUNT };
+enum class AssetDirectory {
+  TEXTURES,
+  FONTS,
+  MAPS,
+  TILESETS,
+  ANIMATIONS,
+  AUDIO,
+  COUNT
+};
+enum class AssetState : uint8_t { LOADING, READY, FAILED };
+enum class TaskAffinity : uint8_t { WORKER, MAIN };
 
 /**
  * Enum for input states.
@@ -55,3 +67,13 @@ enum class Direction { NONE, UP, DOWN, LEFT, RIGHT };
  * PING_PONG: Animation plays forward and then in reverse.
  */
 enum class AnimationDirection { FORWARD, REVERSE, LOOP, PING_PONG };
+
+/**
+ * Enum for movement states, used to pick the animation of a sprite.
+ * IDLE: Standing still.
+ * WALK: Walking.
+ * RUN: Running.
+ * BIKE_IDLE: Standing still on a bike.
+ * BIKE: Riding a bike.
+ */
+enum class MovementState { IDLE, WALK, RUN, BIKE_IDLE, BIKE, COUNT };
@@ -0,0 +1,73 @@
+#include "frame_clock.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// the end of a wait is spent yielding, sleeps may overshoot by a scheduler
+// quantum
+constexpr auto SLEEP_MARGIN = std::chrono::milliseconds(1);
+
+// weight of the last frame in the displayed frame rate
+constexpr double FPS_SMOOTHING = 0.1;
+
+} // namespace
+
+void FrameClock::reset() {
+  _frame_start = Clock::now();
+  _accumulator = 0.0;
+  _frame_time = 0.0;
+  _fps = 0.0;
+}
+
+void FrameClock::set_step_rate(uint16_t hz) {
+  _step = 1.0 / std::max<uint16_t>(hz, 1);
+}
+
+void FrameClock::set_max_fps(uint16_t fps) {
+  _min_frame_duration =
+      fps == 0 ? Clock::duration::zero()
+               : std::chrono::duration_cast<Clock::duration>(
+                     std::chrono::duration<double>(1.0 / fps));
+}
+
+int FrameClock::begin_frame() {
+  Clock::time_point now = Clock::now();
+  _frame_time = std::chrono::duration<double>(now - _frame_start).count();
+  _frame_start = now;
+
+  if (_frame_time > 0.0) {
+    double fps = 1.0 / _frame_time;
+    _fps = _fps == 0.0 ? fps : _fps + (fps - _fps) * FPS_SMOOTHING;
+  }
+
+  _accumulator += std::min(_frame_time, MAX_FRAME_TIME);
+
+  int steps = static_cast<int>(_accumulator / _step);
+  if (steps > MAX_STEPS_PER_FRAME) {
+    // too slow to keep up, drop the time rather than falling further behind
+    steps = MAX_STEPS_PER_FRAME;
+    _accumulator = 0.0;
+  } else {
+    _accumulator -= steps * _step;
+  }
+
+  return steps;
+}
+
+void FrameClock::wait_for_next_frame() {
+#ifndef __EMSCRIPTEN__
+  if (_min_frame_duration == Clock::duration::zero()) {
+    return;
+  }
+
+  Clock::time_point deadline = _frame_start + _min_frame_duration;
+  if (deadline - Clock::now() > SLEEP_MARGIN) {
+    std::this_thread::sleep_until(deadline - SLEEP_MARGIN);
+  }
+  while (Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+#endif
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Paces the main loop. The simulation advances in fixed steps taken out of
+ * an accumulator fed by the real elapsed time, and rendering blends the last
+ * two simulated states by the fraction of a step left over. The frame rate
+ * is capped by sleeping until the next frame is due rather than spinning.
+ */
+class FrameClock {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // frames longer than this are cut short, e.g. after a breakpoint or a
+  // window drag, instead of being simulated in one burst
+  static constexpr double MAX_FRAME_TIME = 0.25;
+  // steps run in a single frame at most, the rest of the time is dropped
+  static constexpr int MAX_STEPS_PER_FRAME = 8;
+
+  FrameClock() = default;
+
+  void reset();
+
+  // simulation steps per second
+  void set_step_rate(uint16_t hz);
+  // 0 leaves the frame rate uncapped
+  void set_max_fps(uint16_t fps);
+
+  /**
+   * Start a frame, feeding the time elapsed since the previous one to the
+   * accumulator.
+   * @return The number of fixed steps to simulate this frame.
+   */
+  int begin_frame();
+
+  // sleep until the frame rate cap allows the next frame to start
+  void wait_for_next_frame();
+
+  // duration of a simulation step, in seconds
+  double get_step() const { return _step; }
+  // how far the rendered frame is between the previous and the current
+  // simulated states, in [0, 1)
+  float get_alpha() const { return static_cast<float>(_accumulator / _step); }
+
+  // real duration of the last frame, in seconds
+  double get_frame_time() const { return _frame_time; }
+  // frames per second, smoothed over the last frames
+  double get_fps() const { return _fps; }
+
+private:
+  Clock::time_point _frame_start;
+  double _step = 1.0 / 60.0;
+  Clock::duration _min_frame_duration = Clock::duration::zero();
+  double _accumulator = 0.0;
+  double _frame_time = 0.0;
+  double _fps = 0.0;
+};
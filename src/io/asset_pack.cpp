@@ -0,0 +1,278 @@
+#include "asset_pack.h"
+#include "lz4.h"
+#include <managers/logger/logger_manager.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+// a compressed entry is kept when at most this fraction of the stored one
+constexpr double MIN_COMPRESSION_GAIN = 0.9;
+// lz4 cannot expand data more than about 255 times, bounds untrusted sizes
+constexpr uint64_t MAX_LZ4_RATIO = 255;
+
+size_t align(size_t offset) {
+  return (offset + AssetPackFormat::DATA_ALIGNMENT - 1) &
+         ~static_cast<size_t>(AssetPackFormat::DATA_ALIGNMENT - 1);
+}
+
+struct PackedFile {
+  AssetPackFormat::Entry entry;
+  std::vector<uint8_t> data;
+};
+
+bool read_file(const std::filesystem::path &path, std::vector<uint8_t> &data) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::streamsize size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  data.resize(static_cast<size_t>(std::max<std::streamsize>(size, 0)));
+  return size <= 0 ||
+         static_cast<bool>(
+             file.read(reinterpret_cast<char *>(data.data()), size));
+}
+
+} // namespace
+
+bool AssetPack::open(const std::string &path) {
+  close();
+
+  if (!_file.open(path)) {
+    return false;
+  }
+
+  const auto *header = _file.get<AssetPackFormat::Header>(0);
+  if (header == nullptr ||
+      std::memcmp(header->magic, AssetPackFormat::MAGIC,
+                  sizeof(header->magic)) != 0 ||
+      header->version != AssetPackFormat::VERSION) {
+    LoggerManager::log_error("Could not open asset pack " + path +
+                             ": invalid header");
+    _file.close();
+    return false;
+  }
+
+  _entries = _file.get<AssetPackFormat::Entry>(sizeof(AssetPackFormat::Header),
+                                                header->entry_count);
+  if (header->entry_count > 0 && _entries == nullptr) {
+    LoggerManager::log_error("Could not open asset pack " + path +
+                             ": truncated index");
+    _file.close();
+    return false;
+  }
+
+  // find() relies on the order written by build()
+  if (!std::is_sorted(_entries, _entries + header->entry_count,
+                      [](const AssetPackFormat::Entry &a,
+                         const AssetPackFormat::Entry &b) {
+                        return a.hash < b.hash;
+                      })) {
+    LoggerManager::log_error("Could not open asset pack " + path +
+                             ": index not sorted by hash");
+    _entries = nullptr;
+    _file.close();
+    return false;
+  }
+  _entry_count = header->entry_count;
+
+  return true;
+}
+
+void AssetPack::close() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _decompressed.clear();
+  _entries = nullptr;
+  _entry_count = 0;
+  _file.close();
+}
+
+uint64_t AssetPack::hash(AssetDirectory directory, std::string_view name) {
+  // FNV-1a, the directory first
+  uint64_t value = 14695981039346656037ull;
+  value = (value ^ static_cast<uint8_t>(directory)) * 1099511628211ull;
+  for (char c : name) {
+    value = (value ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  }
+  return value;
+}
+
+const AssetPackFormat::Entry *AssetPack::find(AssetDirectory directory,
+                                              std::string_view name) const {
+  if (_entries == nullptr) {
+    return nullptr;
+  }
+
+  uint64_t key = hash(directory, name);
+  const auto *end = _entries + _entry_count;
+  const auto *it = std::lower_bound(
+      _entries, end, key,
+      [](const AssetPackFormat::Entry &entry, uint64_t key) {
+        return entry.hash < key;
+      });
+
+  // names sharing a hash are next to each other
+  for (; it != end && it->hash == key; ++it) {
+    if (it->directory == static_cast<uint32_t>(directory) &&
+        name == std::string_view(it->name, strnlen(it->name, sizeof(it->name)))) {
+      return it;
+    }
+  }
+  return nullptr;
+}
+
+AssetPack::Data AssetPack::get_data(AssetDirectory directory,
+                                    std::string_view name) {
+  const AssetPackFormat::Entry *entry = find(directory, name);
+  if (entry == nullptr) {
+    return {};
+  }
+
+  const auto *stored = _file.get<uint8_t>(entry->data_offset, entry->stored_size);
+  if (stored == nullptr) {
+    LoggerManager::log_error("Asset pack entry " + std::string(name) +
+                             " is truncated");
+    return {};
+  }
+
+  if (entry->compression == AssetPackFormat::NONE) {
+    if (entry->size != entry->stored_size) {
+      LoggerManager::log_error("Asset pack entry " + std::string(name) +
+                               " has a size not matching its stored size");
+      return {};
+    }
+    return {stored, static_cast<size_t>(entry->size)};
+  }
+
+  if (entry->compression != AssetPackFormat::LZ4) {
+    LoggerManager::log_error("Asset pack entry " + std::string(name) +
+                             " has an unknown compression");
+    return {};
+  }
+
+  if (entry->size > entry->stored_size * MAX_LZ4_RATIO) {
+    LoggerManager::log_error("Asset pack entry " + std::string(name) +
+                             " has an invalid size");
+    return {};
+  }
+
+  size_t index = static_cast<size_t>(entry - _entries);
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto it = _decompressed.find(index);
+  if (it != _decompressed.end()) {
+    return {it->second.data(), it->second.size()};
+  }
+
+  std::vector<uint8_t> data(entry->size);
+  if (!Lz4::decompress(stored, entry->stored_size, data.data(), data.size())) {
+    LoggerManager::log_error("Could not decompress asset pack entry " +
+                             std::string(name));
+    return {};
+  }
+
+  auto &kept = _decompressed[index] = std::move(data);
+  return {kept.data(), kept.size()};
+}
+
+bool AssetPack::build(const std::string &file_path, bool compress) {
+  std::vector<PackedFile> files;
+
+  for (int i = 0; i < static_cast<int>(AssetDirectory::COUNT); i++) {
+    auto directory = static_cast<AssetDirectory>(i);
+    std::filesystem::path root(ApplicationConfig::get_asset_path(directory));
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(root, error)) {
+      continue;
+    }
+
+    for (const auto &item :
+         std::filesystem::recursive_directory_iterator(root, error)) {
+      if (!item.is_regular_file() ||
+          std::filesystem::equivalent(item.path(), file_path, error)) {
+        continue;
+      }
+
+      std::string name =
+          std::filesystem::relative(item.path(), root).generic_string();
+      if (name.size() >= AssetPackFormat::NAME_SIZE) {
+        LoggerManager::log_warning("Asset name " + name +
+                                   " is too long to be packed, skipping it");
+        continue;
+      }
+
+      PackedFile file = {};
+      if (!read_file(item.path(), file.data)) {
+        LoggerManager::log_error("Could not read file " + item.path().string());
+        return false;
+      }
+
+      file.entry.hash = hash(directory, name);
+      file.entry.size = file.data.size();
+      file.entry.directory = static_cast<uint32_t>(directory);
+      file.entry.compression = AssetPackFormat::NONE;
+      std::memcpy(file.entry.name, name.data(), name.size());
+
+      if (compress && !file.data.empty()) {
+        std::vector<uint8_t> compressed =
+            Lz4::compress(file.data.data(), file.data.size());
+        if (compressed.size() <= file.data.size() * MIN_COMPRESSION_GAIN) {
+          file.data = std::move(compressed);
+          file.entry.compression = AssetPackFormat::LZ4;
+        }
+      }
+      file.entry.stored_size = file.data.size();
+
+      files.push_back(std::move(file));
+    }
+  }
+
+  std::sort(files.begin(), files.end(),
+            [](const PackedFile &a, const PackedFile &b) {
+              return a.entry.hash < b.entry.hash;
+            });
+
+  AssetPackFormat::Header header = {};
+  std::memcpy(header.magic, AssetPackFormat::MAGIC, sizeof(header.magic));
+  header.version = AssetPackFormat::VERSION;
+  header.entry_count = files.size();
+
+  // the data follows the index, one aligned block per entry
+  size_t offset = sizeof(AssetPackFormat::Header) +
+                  files.size() * sizeof(AssetPackFormat::Entry);
+  for (auto &file : files) {
+    file.entry.data_offset = offset;
+    offset = align(offset + file.data.size());
+  }
+
+  std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+  if (!output.is_open()) {
+    LoggerManager::log_error("Could not open file " + file_path);
+    return false;
+  }
+
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (const auto &file : files) {
+    output.write(reinterpret_cast<const char *>(&file.entry),
+                 sizeof(file.entry));
+  }
+
+  const char padding[AssetPackFormat::DATA_ALIGNMENT] = {};
+  for (const auto &file : files) {
+    output.write(reinterpret_cast<const char *>(file.data.data()),
+                 file.data.size());
+    output.write(padding, align(file.data.size()) - file.data.size());
+  }
+
+  if (!output.good()) {
+    LoggerManager::log_error("Could not write file " + file_path);
+    return false;
+  }
+
+  return true;
+}
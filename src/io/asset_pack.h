@@ -0,0 +1,66 @@
+#pragma once
+
+#include "asset_pack_format.h"
+#include "mapped_file.h"
+#include <core/config.h>
+
+#include <mutex>
+#include <string_view>
+
+/**
+ * Every asset in a single mapped file, looked up by directory and name. The
+ * stored entries are read in place, the compressed ones are decompressed on
+ * first use and kept until the pack is closed.
+ *
+ * Lookups are safe from any thread once the pack is open.
+ */
+class AssetPack {
+public:
+  struct Data {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+  };
+
+  AssetPack() = default;
+
+  AssetPack(const AssetPack &) = delete;
+  AssetPack &operator=(const AssetPack &) = delete;
+
+  bool open(const std::string &path);
+  void close();
+
+  bool is_open() const { return _file.is_open(); }
+  size_t get_entry_count() const { return _entry_count; }
+
+  bool contains(AssetDirectory directory, std::string_view name) const {
+    return find(directory, name) != nullptr;
+  }
+
+  /**
+   * Get the bytes of an asset, valid until the pack is closed.
+   * @return null data if the pack has no such asset or it is corrupted.
+   */
+  Data get_data(AssetDirectory directory, std::string_view name);
+
+  /**
+   * Pack every file of the asset directories.
+   * @param compress Store the entries compressed with LZ4 when it makes them
+   * notably smaller, already compressed images mostly stay stored.
+   * @return true if the pack was written.
+   */
+  static bool build(const std::string &file_path, bool compress);
+
+  static uint64_t hash(AssetDirectory directory, std::string_view name);
+
+private:
+  const AssetPackFormat::Entry *find(AssetDirectory directory,
+                                     std::string_view name) const;
+
+  MappedFile _file;
+  const AssetPackFormat::Entry *_entries = nullptr;
+  size_t _entry_count = 0;
+
+  // decompressed entries, by index
+  std::mutex _mutex;
+  std::unordered_map<size_t, std::vector<uint8_t>> _decompressed;
+};
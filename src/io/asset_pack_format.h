@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Binary layout of an asset pack (.pza), written by AssetPack::build and used
+ * in place once mapped in memory. All values are little endian.
+ *
+ *   AssetPackFormat::Header
+ *   AssetPackFormat::Entry[entry_count], sorted by hash
+ *   data of every entry, each block aligned on 8 bytes
+ */
+namespace AssetPackFormat {
+
+constexpr char MAGIC[4] = {'P', 'Z', 'A', 'P'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t NAME_SIZE = 112;
+constexpr uint32_t DATA_ALIGNMENT = 8;
+
+enum Compression : uint32_t { NONE = 0, LZ4 = 1 };
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+};
+
+struct Entry {
+  // hash of the directory and the name, see AssetPack::hash
+  uint64_t hash;
+  uint64_t data_offset; // from the start of the file
+  // size once decompressed
+  uint64_t size;
+  // size in the file
+  uint64_t stored_size;
+  uint32_t directory;
+  uint32_t compression;
+  // relative to the directory, compared on a hash match
+  char name[NAME_SIZE];
+};
+
+static_assert(sizeof(Header) % DATA_ALIGNMENT == 0);
+static_assert(sizeof(Entry) % DATA_ALIGNMENT == 0);
+
+} // namespace AssetPackFormat
@@ -0,0 +1,142 @@
+#include "baked_texture.h"
+#include <managers/logger/logger_manager.h>
+
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+bool BakedTexture::open(const std::string &path, uint64_t source_hash,
+                        size_t source_size, uint32_t pixel_format) {
+  close();
+
+  if (!_file.open(path)) {
+    return false;
+  }
+
+  const auto *header = _file.get<BakedTextureFormat::Header>(0);
+  if (header == nullptr ||
+      std::memcmp(header->magic, BakedTextureFormat::MAGIC,
+                  sizeof(header->magic)) != 0 ||
+      header->version != BakedTextureFormat::VERSION ||
+      header->source_hash != source_hash ||
+      header->source_size != source_size ||
+      header->pixel_format != pixel_format || header->width == 0 ||
+      header->height == 0 ||
+      header->pitch < static_cast<uint64_t>(header->width) *
+                          SDL_BYTESPERPIXEL(pixel_format)) {
+    // stale, rebaked by the caller
+    _file.close();
+    return false;
+  }
+
+  _pixels = _file.get<uint8_t>(header->data_offset,
+                               static_cast<size_t>(header->pitch) *
+                                   header->height);
+  if (_pixels == nullptr) {
+    LoggerManager::log_warning("Baked texture " + path + " is truncated");
+    _file.close();
+    return false;
+  }
+
+  _header = header;
+  return true;
+}
+
+void BakedTexture::close() {
+  _header = nullptr;
+  _pixels = nullptr;
+  _file.close();
+}
+
+SDL_Texture *BakedTexture::upload(SDL_Renderer *renderer) const {
+  if (_header == nullptr) {
+    return nullptr;
+  }
+
+  SDL_Texture *texture =
+      SDL_CreateTexture(renderer, _header->pixel_format,
+                        SDL_TEXTUREACCESS_STATIC, _header->width,
+                        _header->height);
+  if (texture == nullptr) {
+    return nullptr;
+  }
+
+  if (SDL_UpdateTexture(texture, nullptr, _pixels, _header->pitch) != 0) {
+    SDL_DestroyTexture(texture);
+    return nullptr;
+  }
+
+  // as SDL_CreateTextureFromSurface does for images with alpha
+  if (SDL_ISPIXELFORMAT_ALPHA(_header->pixel_format)) {
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  }
+  return texture;
+}
+
+bool BakedTexture::bake(const std::string &path, SDL_Surface *surface,
+                        uint64_t source_hash, size_t source_size) {
+  BakedTextureFormat::Header header = {};
+  std::memcpy(header.magic, BakedTextureFormat::MAGIC, sizeof(header.magic));
+  header.version = BakedTextureFormat::VERSION;
+  header.source_hash = source_hash;
+  header.source_size = source_size;
+  header.pixel_format = surface->format->format;
+  header.width = surface->w;
+  header.height = surface->h;
+  header.pitch = surface->pitch;
+  header.data_offset = sizeof(header);
+
+  std::error_code error;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(),
+                                      error);
+
+  // several threads may bake the same image, each one writes its own file
+  std::string temporary_path =
+      path + "." +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+      ".tmp";
+
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      LoggerManager::log_warning("Could not open file " + temporary_path);
+      return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(static_cast<const char *>(surface->pixels),
+               static_cast<std::streamsize>(surface->pitch) * surface->h);
+
+    if (!file.good()) {
+      LoggerManager::log_warning("Could not write file " + temporary_path);
+      file.close();
+      std::filesystem::remove(temporary_path, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    LoggerManager::log_warning("Could not write file " + path + ": " +
+                               error.message());
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+  return true;
+}
+
+uint64_t BakedTexture::hash(const uint8_t *data, size_t size) {
+  // FNV-1a over 8 byte words, the sources are several megabytes
+  uint64_t value = 14695981039346656037ull ^ size;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    value = (value ^ word) * 1099511628211ull;
+    value ^= value >> 32;
+  }
+  for (; i < size; i++) {
+    value = (value ^ data[i]) * 1099511628211ull;
+  }
+  return value;
+}
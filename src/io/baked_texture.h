@@ -0,0 +1,64 @@
+#pragma once
+
+#include "baked_texture_format.h"
+#include "mapped_file.h"
+#include <core/config.h>
+
+/**
+ * A decoded image mapped from the texture cache, uploaded without decoding
+ * or converting its pixels again. The cache file is only used when it was
+ * baked from the same source image for the same pixel format.
+ */
+class BakedTexture {
+public:
+  BakedTexture() = default;
+
+  BakedTexture(const BakedTexture &) = delete;
+  BakedTexture &operator=(const BakedTexture &) = delete;
+  BakedTexture(BakedTexture &&other) noexcept { *this = std::move(other); }
+  BakedTexture &operator=(BakedTexture &&other) noexcept {
+    if (this != &other) {
+      _file = std::move(other._file);
+      _header = other._header;
+      _pixels = other._pixels;
+      other._header = nullptr;
+      other._pixels = nullptr;
+    }
+    return *this;
+  }
+
+  /**
+   * Map a baked texture.
+   * @return false if the file does not exist, is corrupted, or does not
+   * match the source or the format anymore.
+   */
+  bool open(const std::string &path, uint64_t source_hash, size_t source_size,
+            uint32_t pixel_format);
+  void close();
+
+  bool is_open() const { return _header != nullptr; }
+  int get_width() const { return _header->width; }
+  int get_height() const { return _header->height; }
+  int get_pitch() const { return _header->pitch; }
+  uint32_t get_pixel_format() const { return _header->pixel_format; }
+  const uint8_t *get_pixels() const { return _pixels; }
+
+  // create a static texture from the mapped pixels, on the renderer thread
+  SDL_Texture *upload(SDL_Renderer *renderer) const;
+
+  /**
+   * Write the pixels of a surface, already converted to the pixel format of
+   * the renderer. The file is replaced at once, readers never see it
+   * half-written.
+   * @return true if the file was written.
+   */
+  static bool bake(const std::string &path, SDL_Surface *surface,
+                   uint64_t source_hash, size_t source_size);
+
+  static uint64_t hash(const uint8_t *data, size_t size);
+
+private:
+  MappedFile _file;
+  const BakedTextureFormat::Header *_header = nullptr;
+  const uint8_t *_pixels = nullptr;
+};
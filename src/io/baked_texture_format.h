@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Binary layout of a baked texture (.pzt), the decoded pixels of an image in
+ * the pixel format of the renderer, written by BakedTexture::bake and
+ * uploaded in place once mapped in memory. All values are little endian.
+ *
+ *   BakedTextureFormat::Header
+ *   height rows of pitch bytes, starting at data_offset
+ */
+namespace BakedTextureFormat {
+
+constexpr char MAGIC[4] = {'P', 'Z', 'T', 'X'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t DATA_ALIGNMENT = 16;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  // hash of the encoded source image, see BakedTexture::hash
+  uint64_t source_hash;
+  uint64_t source_size;
+  // an SDL_PixelFormatEnum value
+  uint32_t pixel_format;
+  uint32_t width;
+  uint32_t height;
+  uint32_t pitch;
+  uint64_t data_offset; // from the start of the file
+};
+
+static_assert(sizeof(Header) % DATA_ALIGNMENT == 0);
+
+} // namespace BakedTextureFormat
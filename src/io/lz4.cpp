@@ -0,0 +1,176 @@
+#include "lz4.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+// the format wants the last literals to be at least this long
+constexpr size_t LAST_LITERALS = 5;
+// and no match to start closer to the end of the block
+constexpr size_t MATCH_SAFE_DISTANCE = 12;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+uint32_t read_u32(const uint8_t *p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// lengths past 15 go on extra bytes, 255 at a time
+void write_length(std::vector<uint8_t> &output, size_t length) {
+  while (length >= 255) {
+    output.push_back(255);
+    length -= 255;
+  }
+  output.push_back(static_cast<uint8_t>(length));
+}
+
+void write_sequence(std::vector<uint8_t> &output, const uint8_t *literals,
+                    size_t literal_length, size_t offset, size_t match_length) {
+  uint8_t token =
+      static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+  if (match_length > 0) {
+    token |= static_cast<uint8_t>(
+        std::min<size_t>(match_length - MIN_MATCH, 15));
+  }
+  output.push_back(token);
+
+  if (literal_length >= 15) {
+    write_length(output, literal_length - 15);
+  }
+  output.insert(output.end(), literals, literals + literal_length);
+
+  // the last sequence has no match
+  if (match_length == 0) {
+    return;
+  }
+  output.push_back(static_cast<uint8_t>(offset & 0xFF));
+  output.push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_length - MIN_MATCH >= 15) {
+    write_length(output, match_length - MIN_MATCH - 15);
+  }
+}
+
+} // namespace
+
+namespace Lz4 {
+
+std::vector<uint8_t> compress(const uint8_t *source, size_t size) {
+  std::vector<uint8_t> output;
+  output.reserve(compress_bound(size));
+
+  size_t anchor = 0;
+  if (size > MATCH_SAFE_DISTANCE) {
+    // positions + 1 of the last sequence seen per hash, 0 when none
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+    size_t match_limit = size - MATCH_SAFE_DISTANCE;
+    size_t position = 0;
+
+    while (position < match_limit) {
+      uint32_t sequence = read_u32(source + position);
+      uint32_t &slot = table[hash(sequence)];
+      size_t candidate = slot;
+      slot = static_cast<uint32_t>(position + 1);
+
+      if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET ||
+          read_u32(source + candidate - 1) != sequence) {
+        position++;
+        continue;
+      }
+      candidate--;
+
+      size_t length = MIN_MATCH;
+      size_t end = size - LAST_LITERALS;
+      while (position + length < end &&
+             source[position + length] == source[candidate + length]) {
+        length++;
+      }
+
+      write_sequence(output, source + anchor, position - anchor,
+                     position - candidate, length);
+      position += length;
+      anchor = position;
+    }
+  }
+
+  write_sequence(output, source + anchor, size - anchor, 0, 0);
+  return output;
+}
+
+bool decompress(const uint8_t *source, size_t source_size,
+                uint8_t *destination, size_t destination_size) {
+  const uint8_t *input = source;
+  const uint8_t *input_end = source + source_size;
+  size_t output = 0;
+
+  // read the extra bytes of a length, false when running past the input
+  auto read_length = [&](size_t &length) {
+    uint8_t byte;
+    do {
+      if (input >= input_end) {
+        return false;
+      }
+      byte = *input++;
+      length += byte;
+    } while (byte == 255);
+    return true;
+  };
+
+  while (input < input_end) {
+    uint8_t token = *input++;
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !read_length(literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<size_t>(input_end - input) ||
+        literal_length > destination_size - output) {
+      return false;
+    }
+    if (literal_length > 0) {
+      std::memcpy(destination + output, input, literal_length);
+    }
+    input += literal_length;
+    output += literal_length;
+
+    // the last sequence ends on its literals
+    if (input == input_end) {
+      break;
+    }
+
+    if (input_end - input < 2) {
+      return false;
+    }
+    size_t offset = input[0] | (input[1] << 8);
+    input += 2;
+    if (offset == 0 || offset > output) {
+      return false;
+    }
+
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && !read_length(match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (match_length > destination_size - output) {
+      return false;
+    }
+
+    // byte by byte, the match may overlap what it copies
+    const uint8_t *match = destination + output - offset;
+    for (size_t i = 0; i < match_length; i++) {
+      destination[output + i] = match[i];
+    }
+    output += match_length;
+  }
+
+  return output == destination_size;
+}
+
+} // namespace Lz4
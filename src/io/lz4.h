@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The LZ4 block format, enough to pack and read assets without the library.
+ * Blocks are compatible with LZ4_compress_default / LZ4_decompress_safe, the
+ * compressor is a plain greedy one favouring simplicity over ratio.
+ */
+namespace Lz4 {
+
+// worst case size of a compressed block
+inline size_t compress_bound(size_t size) { return size + size / 255 + 16; }
+
+std::vector<uint8_t> compress(const uint8_t *source, size_t size);
+
+/**
+ * Decompress a block whose decompressed size is known.
+ * @return false if the block is malformed or does not fill `destination`.
+ */
+bool decompress(const uint8_t *source, size_t source_size,
+                uint8_t *destination, size_t destination_size);
+
+} // namespace Lz4
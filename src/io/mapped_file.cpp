@@ -0,0 +1,92 @@
+#include "mapped_file.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__) || defined(__EMSCRIPTEN__)
+#define HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define HAS_MMAP 0
+#endif
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+
+    _buffer = std::move(other._buffer);
+    _data = other._is_mapped ? other._data : _buffer.data();
+    _size = other._size;
+    _is_mapped = other._is_mapped;
+
+    other._data = nullptr;
+    other._size = 0;
+    other._is_mapped = false;
+  }
+  return *this;
+}
+
+bool MappedFile::open(const std::string &path) {
+  close();
+
+#if HAS_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+
+  size_t mapped_size = static_cast<size_t>(file_stat.st_size);
+  void *address = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid once the descriptor is closed
+  ::close(fd);
+
+  if (address != MAP_FAILED) {
+    _data = static_cast<const uint8_t *>(address);
+    _size = mapped_size;
+    _is_mapped = true;
+    return true;
+  }
+#endif
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::streamsize size = file.tellg();
+  if (size <= 0) {
+    return false;
+  }
+  file.seekg(0, std::ios::beg);
+
+  _buffer.resize(static_cast<size_t>(size));
+  if (!file.read(reinterpret_cast<char *>(_buffer.data()), size)) {
+    _buffer.clear();
+    return false;
+  }
+
+  _data = _buffer.data();
+  _size = _buffer.size();
+  return true;
+}
+
+void MappedFile::close() {
+#if HAS_MMAP
+  if (_is_mapped && _data != nullptr) {
+    munmap(const_cast<uint8_t *>(_data), _size);
+  }
+#endif
+
+  _buffer.clear();
+  _buffer.shrink_to_fit();
+  _data = nullptr;
+  _size = 0;
+  _is_mapped = false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view of a whole file mapped in memory. The pages are only loaded
+ * when touched, so data can be used in place without being copied. Platforms
+ * without mmap fall back to reading the file into a buffer.
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  bool open(const std::string &path);
+  void close();
+
+  bool is_open() const { return _data != nullptr; }
+  const uint8_t *data() const { return _data; }
+  size_t size() const { return _size; }
+
+  /**
+   * Get `count` objects of type T at the given byte offset.
+   * @return nullptr if the range is not inside the file.
+   */
+  template <typename T>
+  const T *get(size_t offset, size_t count = 1) const {
+    if (_data == nullptr || offset > _size ||
+        count > (_size - offset) / sizeof(T) ||
+        offset % alignof(T) != 0) {
+      return nullptr;
+    }
+    return reinterpret_cast<const T *>(_data + offset);
+  }
+
+private:
+  const uint8_t *_data = nullptr;
+  size_t _size = 0;
+  bool _is_mapped = false;
+
+  std::vector<uint8_t> _buffer; // fallback when the file cannot be mapped
+};
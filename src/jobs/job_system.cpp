@@ -0,0 +1,148 @@
+#include "job_system.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+namespace {
+
+// the queue of the current thread, the first one on threads outside the pool
+thread_local size_t t_queue_index = 0;
+
+} // namespace
+
+void JobSystem::start(size_t worker_count) {
+  stop();
+
+#if HAS_THREADS
+  if (worker_count == 0) {
+    worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  }
+
+  _is_stopping = false;
+  _queues.clear();
+  for (size_t i = 0; i < worker_count + 1; i++) {
+    _queues.push_back(std::make_unique<WorkQueue>());
+  }
+  for (size_t i = 0; i < worker_count; i++) {
+    _workers.emplace_back(&JobSystem::run_worker, this, i + 1);
+  }
+#endif
+}
+
+void JobSystem::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+    _is_stopping = true;
+  }
+  _sleep_condition.notify_all();
+
+  for (auto &worker : _workers) {
+    worker.join();
+  }
+  _workers.clear();
+  _queues.clear();
+  _pending = 0;
+}
+
+void JobSystem::parallel_for(size_t count, size_t chunk_size,
+                             const RangeJob &job) {
+  chunk_size = std::max<size_t>(chunk_size, 1);
+  if (_workers.empty() || count <= chunk_size) {
+    if (count > 0) {
+      job(0, count);
+    }
+    return;
+  }
+
+  size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+  std::atomic<size_t> remaining = chunk_count;
+
+  // deal the chunks round robin, the workers steal from each other when the
+  // chunks do not take the same time
+  for (size_t i = 0; i < chunk_count; i++) {
+    size_t begin = i * chunk_size;
+    Task task = {&job, begin, std::min(begin + chunk_size, count), &remaining};
+
+    // counted before being queued, so that it never goes below zero
+    _pending++;
+    WorkQueue &queue = *_queues[(t_queue_index + i) % _queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+
+  {
+    // taken so that a worker cannot miss the wake up between checking for
+    // tasks and going to sleep
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+  }
+  _sleep_condition.notify_all();
+
+  // help instead of waiting, this may run chunks of other loops as well
+  Task task;
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    if (pop(t_queue_index, task)) {
+      run(task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::run_worker(size_t queue_index) {
+  t_queue_index = queue_index;
+
+  Task task;
+  while (true) {
+    if (pop(queue_index, task)) {
+      run(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _sleep_condition.wait(lock,
+                          [this] { return _is_stopping || _pending > 0; });
+    if (_is_stopping) {
+      return;
+    }
+  }
+}
+
+bool JobSystem::pop(size_t queue_index, Task &task) {
+  if (_pending.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
+  // the newest task of its own queue first, its data is likely still cached
+  {
+    WorkQueue &queue = *_queues[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+      _pending--;
+      return true;
+    }
+  }
+
+  // then the oldest task of the next queues
+  for (size_t i = 1; i < _queues.size(); i++) {
+    WorkQueue &queue = *_queues[(queue_index + i) % _queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      _pending--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void JobSystem::run(const Task &task) {
+  (*task.job)(task.begin, task.end);
+  task.remaining->fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A pool of worker threads splitting loops into chunks. Every thread owns a
+ * queue of chunks, takes the newest one of its own queue first and steals the
+ * oldest ones of the other queues when it runs dry, so uneven chunks even out
+ * across the cores. The thread waiting on a loop runs chunks as well.
+ *
+ * Builds without threads (wasm without pthreads) run the loops inline.
+ */
+class JobSystem {
+public:
+  // the range [begin, end) of a loop handled by one chunk
+  using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+  JobSystem() = default;
+  ~JobSystem() { stop(); }
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  static JobSystem *get() {
+    static std::unique_ptr<JobSystem> instance = std::make_unique<JobSystem>();
+    return instance.get();
+  }
+
+  // start the workers, 0 picks one less than the number of cores
+  void start(size_t worker_count = 0);
+  // wait for the workers, must not be called while a loop is running
+  void stop();
+
+  size_t get_worker_count() const { return _workers.size(); }
+
+  /**
+   * Run `job` over [0, count) in chunks of `chunk_size`, spread over the
+   * workers and the calling thread. Returns once every chunk is done.
+   * Loops too small to be split run inline.
+   */
+  void parallel_for(size_t count, size_t chunk_size, const RangeJob &job);
+
+private:
+  struct Task {
+    const RangeJob *job;
+    size_t begin;
+    size_t end;
+    // chunks of the loop left to run
+    std::atomic<size_t> *remaining;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void run_worker(size_t queue_index);
+  // take a task from the given queue, or steal one from another
+  bool pop(size_t queue_index, Task &task);
+  void run(const Task &task);
+
+  // one per worker, the first one is shared by the other threads
+  std::vector<std::unique_ptr<WorkQueue>> _queues;
+  std::vector<std::thread> _workers;
+
+  // tasks waiting in the queues, the idle workers sleep until there are some
+  std::atomic<size_t> _pending = 0;
+  std::mutex _sleep_mutex;
+  std::condition_variable _sleep_condition;
+  bool _is_stopping = false;
+};
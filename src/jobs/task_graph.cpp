@@ -0,0 +1,158 @@
+#include "task_graph.h"
+#include <managers/logger/logger_manager.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+TaskGraph::TaskId TaskGraph::add(std::string name, TaskFunction function,
+                                 std::vector<TaskId> dependencies,
+                                 TaskAffinity affinity) {
+  TaskId id = _tasks.size();
+
+  Task task;
+  task.name = std::move(name);
+  task.function = std::move(function);
+  task.affinity = affinity;
+  task.dependency_count = dependencies.size();
+  _tasks.push_back(std::move(task));
+
+  // depending only on earlier tasks keeps the graph free of cycles
+  for (TaskId dependency : dependencies) {
+    assert(dependency < id);
+    _tasks[dependency].dependents.push_back(id);
+  }
+  return id;
+}
+
+void TaskGraph::run(bool threaded) {
+  _start = std::chrono::steady_clock::now();
+  _ready_workers.clear();
+  _ready_main.clear();
+  _remaining = _tasks.size();
+
+  size_t worker_task_count = 0;
+  for (TaskId id = 0; id < _tasks.size(); id++) {
+    Task &task = _tasks[id];
+    task.waiting_for = task.dependency_count;
+    if (task.affinity == TaskAffinity::WORKER) {
+      worker_task_count++;
+    }
+    if (task.waiting_for == 0) {
+      (task.affinity == TaskAffinity::MAIN ? _ready_main : _ready_workers)
+          .push_back(id);
+    }
+  }
+
+  std::vector<std::thread> workers;
+#if HAS_THREADS
+  if (threaded) {
+    // the calling thread is busy with the main tasks
+    size_t worker_count =
+        std::min<size_t>(worker_task_count,
+                         std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    for (size_t i = 0; i < worker_count; i++) {
+      workers.emplace_back(&TaskGraph::run_worker, this);
+    }
+  }
+#endif
+  _has_workers = !workers.empty();
+
+  while (true) {
+    TaskId id;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] {
+        return _remaining == 0 || !_ready_main.empty() ||
+               (!_has_workers && !_ready_workers.empty());
+      });
+      if (_remaining == 0) {
+        break;
+      }
+
+      auto &queue = _ready_main.empty() ? _ready_workers : _ready_main;
+      id = queue.front();
+      queue.pop_front();
+    }
+    execute(id);
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  _total_time = elapsed_since_start();
+}
+
+void TaskGraph::run_worker() {
+  while (true) {
+    TaskId id;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(
+          lock, [this] { return _remaining == 0 || !_ready_workers.empty(); });
+      if (_ready_workers.empty()) {
+        return;
+      }
+      id = _ready_workers.front();
+      _ready_workers.pop_front();
+    }
+    execute(id);
+  }
+}
+
+void TaskGraph::execute(TaskId id) {
+  Task &task = _tasks[id];
+  task.start = elapsed_since_start();
+  task.function();
+  task.duration = elapsed_since_start() - task.start;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (TaskId dependent_id : task.dependents) {
+      Task &dependent = _tasks[dependent_id];
+      if (--dependent.waiting_for == 0) {
+        (dependent.affinity == TaskAffinity::MAIN ? _ready_main
+                                                  : _ready_workers)
+            .push_back(dependent_id);
+      }
+    }
+    _remaining--;
+  }
+  _condition.notify_all();
+}
+
+double TaskGraph::elapsed_since_start() const {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - _start)
+      .count();
+}
+
+std::vector<TaskGraph::TaskTiming> TaskGraph::get_timings() const {
+  std::vector<TaskTiming> timings;
+  for (const Task &task : _tasks) {
+    timings.push_back({task.name, task.affinity, task.start, task.duration});
+  }
+  return timings;
+}
+
+void TaskGraph::log_report(const std::string &title) const {
+  for (const TaskTiming &timing : get_timings()) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << title << " " << timing.name
+       << (timing.affinity == TaskAffinity::MAIN ? " (main)" : " (worker)")
+       << ": " << timing.duration << "ms, started at " << timing.start << "ms";
+    LoggerManager::log_info(ss.str());
+  }
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2) << title << " done in "
+     << _total_time << "ms";
+  LoggerManager::log_info(ss.str());
+}
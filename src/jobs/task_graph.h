@@ -0,0 +1,91 @@
+#pragma once
+
+#include <core/enums.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Tasks run once, each as soon as the tasks it depends on are done, so the
+ * independent ones overlap. Worker tasks run on threads of the graph, main
+ * tasks one after the other on the thread calling run(), for the work that
+ * needs the renderer. The time spent in every task is kept for a report.
+ *
+ * Builds without threads (wasm without pthreads) run every task on the
+ * calling thread, in the same order.
+ */
+class TaskGraph {
+public:
+  using TaskId = size_t;
+  using TaskFunction = std::function<void()>;
+
+  struct TaskTiming {
+    std::string name;
+    TaskAffinity affinity;
+    // from the start of run(), in milliseconds
+    double start;
+    double duration;
+  };
+
+  TaskGraph() = default;
+
+  TaskGraph(const TaskGraph &) = delete;
+  TaskGraph &operator=(const TaskGraph &) = delete;
+
+  /**
+   * Add a task, its dependencies must have been added before it.
+   * @return The id to depend on the task.
+   */
+  TaskId add(std::string name, TaskFunction function,
+             std::vector<TaskId> dependencies = {},
+             TaskAffinity affinity = TaskAffinity::WORKER);
+
+  /**
+   * Run every task and return once they are all done.
+   * @param threaded Run the worker tasks on threads, 0 workers otherwise.
+   */
+  void run(bool threaded = true);
+
+  // in the order the tasks were added
+  std::vector<TaskTiming> get_timings() const;
+  // from the start of run() to the end of the last task, in milliseconds
+  double get_total_time() const { return _total_time; }
+
+  // one line per task, then the total
+  void log_report(const std::string &title) const;
+
+private:
+  struct Task {
+    std::string name;
+    TaskFunction function;
+    TaskAffinity affinity;
+    std::vector<TaskId> dependents;
+    size_t dependency_count = 0;
+    // dependencies not done yet, while running
+    size_t waiting_for = 0;
+    double start = 0.0;
+    double duration = 0.0;
+  };
+
+  void run_worker();
+  void execute(TaskId id);
+  double elapsed_since_start() const;
+
+  std::vector<Task> _tasks;
+  std::chrono::steady_clock::time_point _start;
+  double _total_time = 0.0;
+
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::deque<TaskId> _ready_workers;
+  std::deque<TaskId> _ready_main;
+  // tasks not done yet
+  size_t _remaining = 0;
+  bool _has_workers = false;
+};
@@ -1,5 +1,7 @@
 #include <animation/animation_controller.h>
 #include <application/application.h>
+#include <io/asset_pack.h>
+#include <map/serializer.h>
 
 #ifdef __EMSCRIPTEN__
 
@@ -18,7 +20,44 @@ extern "C" EMSCRIPTEN_KEEPALIVE void quit() { Application::quit(); }
 
 #else
 
-int main() {
+// convert a Tiled map to the cooked format loaded at runtime:
+// pokezoo --cook-map <map.tmx> <map.pzm>
+int cook_map(const char *source, const char *destination) {
+  std::unique_ptr<MapConfig> config = MapSerializer::load_tmx(source);
+  if (config == nullptr) {
+    LoggerManager::log_error("Could not load map " + std::string(source));
+    return EXIT_FAILURE;
+  }
+
+  if (!MapSerializer::cook(*config, destination)) {
+    return EXIT_FAILURE;
+  }
+
+  LoggerManager::log_info("Cooked map " + std::string(source) + " to " +
+                          destination);
+  return 0;
+}
+
+// pack every asset into a single file read at runtime:
+// pokezoo --pack-assets <assets.pza> [--lz4]
+int pack_assets(const char *destination, bool compress) {
+  if (!AssetPack::build(destination, compress)) {
+    return EXIT_FAILURE;
+  }
+
+  LoggerManager::log_info("Packed assets to " + std::string(destination));
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc == 4 && std::string(argv[1]) == "--cook-map") {
+    return cook_map(argv[2], argv[3]);
+  }
+
+  if ((argc == 3 || argc == 4) && std::string(argv[1]) == "--pack-assets") {
+    return pack_assets(argv[2], argc == 4 && std::string(argv[3]) == "--lz4");
+  }
+
   try {
     Application::run();
   } catch (const std::exception &e) {
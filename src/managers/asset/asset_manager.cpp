@@ -1,17 +1,55 @@
 #include "asset_manager.h"
 #include <application/application.h>
 
+#include <cstring>
+#include <filesystem>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+SDL_Texture *TextureHandle::get() const {
+  if (_slot != nullptr) {
+    SDL_Texture *texture = _slot->texture.load(std::memory_order_acquire);
+    if (texture != nullptr) {
+      return texture;
+    }
+  }
+  return AssetManager::get()->get_placeholder();
+}
+
 void AssetManager::clean() {
-  for (auto &[name, texture] : _textures) {
-    SDL_DestroyTexture(texture);
+  stop_streaming();
+
+  for (auto &[name, entry] : _textures) {
+    SDL_DestroyTexture(entry.texture);
   }
 
   for (auto &[name, font] : _fonts) {
     TTF_CloseFont(font);
   }
 
+  // the handles still held fall back on the placeholder
+  for (auto &[name, slot] : _streamed) {
+    slot->texture = nullptr;
+    slot->state = AssetState::FAILED;
+  }
+
+  if (_owns_placeholder && _placeholder != nullptr) {
+    SDL_DestroyTexture(_placeholder);
+  }
+  _placeholder = nullptr;
+  _owns_placeholder = false;
+
   _textures.clear();
   _fonts.clear();
+  _streamed.clear();
+  _streamed_pending = 0;
+  _texture_bytes = 0;
+  // after the fonts reading from it
+  _pack.close();
 }
 
 SDL_Texture *AssetManager::get_texture(const char *name,
@@ -23,36 +61,28 @@ SDL_Texture *AssetManager::get_texture(const char *name,
   auto it = textures.find(name);
 
   if (it != textures.end()) {
-    return it->second;
+    // the pointer may be kept anywhere from now on
+    it->second.is_pinned = true;
+    it->second.last_use = manager._update_count;
+    return it->second.texture;
   }
 
-  std::string path =
-      ApplicationConfig::get_asset_path(directory).data() + std::string(name);
-
-  SDL_Surface *surface = IMG_Load(path.c_str());
+  DecodedImage image = decode({name, directory});
 
-  if (surface == nullptr) {
-    std::cerr << "SDL_Surface is null !\nIt is likely that the image file "
-              << path << " does not exist or is not a valid image file"
-              << std::endl;
-    exit(EXIT_FAILURE);
+  if (!image.is_valid()) {
+    return nullptr;
   }
 
   if (renderer == nullptr) {
     renderer = Application::get()->get_renderer();
   }
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+  SDL_Texture *texture = create_texture(image, renderer);
 
   if (texture == nullptr) {
-    std::cerr << "SDL_Texture is null!\nIt is likely that the image file "
-              << path << " does not exist or is not a valid image file"
-              << std::endl;
-    exit(EXIT_FAILURE);
+    return nullptr;
   }
 
-  SDL_FreeSurface(surface);
-
-  textures[name] = texture;
+  manager.add_texture(name, texture, true);
 
   return texture;
 }
@@ -69,9 +99,16 @@ TTF_Font *AssetManager::get_font(const char *name, int size) {
     return it->second;
   }
 
-  std::string path = ApplicationConfig::font_path + name;
-
-  TTF_Font *font = TTF_OpenFont(path.c_str(), size);
+  // the pack outlives the fonts, they read from it in place
+  TTF_Font *font = nullptr;
+  AssetPack::Data data = manager._pack.get_data(AssetDirectory::FONTS, name);
+  if (data.data != nullptr) {
+    font = TTF_OpenFontRW(
+        SDL_RWFromConstMem(data.data, static_cast<int>(data.size)), 1, size);
+  } else {
+    std::string path = ApplicationConfig::font_path + name;
+    font = TTF_OpenFont(path.c_str(), size);
+  }
 
   if (font == nullptr) {
     std::cerr << "TTF_Font is null" << std::endl;
@@ -82,3 +119,473 @@ TTF_Font *AssetManager::get_font(const char *name, int size) {
 
   return font;
 }
+
+TextureHandle AssetManager::request_texture(const char *name,
+                                            AssetDirectory directory) {
+  auto &manager = *AssetManager::get();
+
+  auto loaded = manager._textures.find(name);
+  if (loaded != manager._textures.end()) {
+    loaded->second.last_use = manager._update_count;
+  }
+
+  auto streamed = manager._streamed.find(name);
+  if (streamed != manager._streamed.end()) {
+    return TextureHandle(streamed->second);
+  }
+
+  auto slot = std::make_shared<TextureSlot>();
+  manager._streamed[name] = slot;
+
+  if (loaded != manager._textures.end()) {
+    slot->texture = loaded->second.texture;
+    slot->state = AssetState::READY;
+    return TextureHandle(slot);
+  }
+
+  DecodeRequest request = {name, directory};
+  manager._streamed_pending++;
+
+  if (manager._decoders.empty()) {
+    // no streaming thread, decode now and upload with the next update
+    manager._decoded.push_back(decode(std::move(request)));
+    return TextureHandle(slot);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(manager._stream_mutex);
+    manager._decode_queue.push_back(std::move(request));
+  }
+  manager._stream_condition.notify_one();
+
+  return TextureHandle(slot);
+}
+
+void AssetManager::update(double budget_ms) {
+  auto &manager = *AssetManager::get();
+  manager._update_count++;
+
+  auto start = std::chrono::steady_clock::now();
+  auto budget = std::chrono::duration<double, std::milli>(budget_ms);
+
+  while (manager._streamed_pending > 0) {
+    DecodedImage image;
+    {
+      std::lock_guard<std::mutex> lock(manager._stream_mutex);
+      if (manager._decoded.empty()) {
+        break;
+      }
+      image = std::move(manager._decoded.front());
+      manager._decoded.pop_front();
+    }
+
+    manager.upload(image);
+
+    // the remaining images are uploaded on the next frames
+    if (std::chrono::steady_clock::now() - start >= budget) {
+      break;
+    }
+  }
+
+  if (manager._texture_bytes > manager._texture_budget) {
+    manager.evict();
+  }
+}
+
+AssetStats AssetManager::get_stats() {
+  AssetStats stats;
+  stats.texture_bytes = _texture_bytes;
+  stats.texture_count = _textures.size();
+  stats.evicted_count = _evicted_count;
+
+  std::lock_guard<std::mutex> lock(_stream_mutex);
+  for (const auto &image : _decoded) {
+    if (image.surface != nullptr) {
+      stats.pending_bytes +=
+          static_cast<size_t>(image.surface->pitch) * image.surface->h;
+    }
+  }
+  return stats;
+}
+
+void AssetManager::start_streaming(size_t worker_count) {
+  stop_streaming();
+
+#if HAS_THREADS
+  if (worker_count == 0) {
+    worker_count = std::max(std::thread::hardware_concurrency() / 2, 1u);
+  }
+
+  _is_stopping = false;
+  for (size_t i = 0; i < worker_count; i++) {
+    _decoders.emplace_back(&AssetManager::run_decoder, this);
+  }
+#endif
+}
+
+void AssetManager::stop_streaming() {
+  {
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _is_stopping = true;
+  }
+  _stream_condition.notify_all();
+
+  for (auto &decoder : _decoders) {
+    decoder.join();
+  }
+  _decoders.clear();
+
+  // nothing will upload the requests left, their handles keep the placeholder
+  for (auto &request : _decode_queue) {
+    _streamed[request.name]->state = AssetState::FAILED;
+  }
+  for (auto &image : _decoded) {
+    SDL_FreeSurface(image.surface);
+    _streamed[image.name]->state = AssetState::FAILED;
+  }
+  _decode_queue.clear();
+  _decoded.clear();
+  _streamed_pending = 0;
+}
+
+SDL_Texture *AssetManager::get_placeholder() {
+  if (_placeholder != nullptr) {
+    return _placeholder;
+  }
+
+  SDL_Renderer *renderer = Application::get()->get_renderer();
+  if (renderer == nullptr) {
+    return nullptr;
+  }
+
+  // a single transparent pixel, stretched to any size
+  _placeholder = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                   SDL_TEXTUREACCESS_STATIC, 1, 1);
+  if (_placeholder != nullptr) {
+    uint32_t pixel = 0;
+    SDL_UpdateTexture(_placeholder, nullptr, &pixel, sizeof(pixel));
+    SDL_SetTextureBlendMode(_placeholder, SDL_BLENDMODE_BLEND);
+    _owns_placeholder = true;
+  }
+  return _placeholder;
+}
+
+void AssetManager::run_decoder() {
+  while (true) {
+    DecodeRequest request;
+    {
+      std::unique_lock<std::mutex> lock(_stream_mutex);
+      _stream_condition.wait(
+          lock, [this] { return _is_stopping || !_decode_queue.empty(); });
+      if (_is_stopping) {
+        return;
+      }
+      request = std::move(_decode_queue.front());
+      _decode_queue.pop_front();
+    }
+
+    // decoding is the slow part and needs no renderer
+    DecodedImage image = decode(std::move(request));
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _decoded.push_back(std::move(image));
+  }
+}
+
+AssetManager::DecodedImage AssetManager::decode(DecodeRequest request) {
+  return decode(std::move(request.name), request.directory,
+                get()->_texture_format);
+}
+
+AssetManager::DecodedImage AssetManager::decode(std::string name,
+                                                AssetDirectory directory,
+                                                uint32_t format) {
+  DecodedImage image;
+  image.name = std::move(name);
+
+  std::vector<uint8_t> buffer;
+  AssetPack::Data source = read_source(image.name, directory, buffer);
+  if (source.data == nullptr) {
+    LoggerManager::log_error("Could not read image " + image.name);
+    return image;
+  }
+
+  // the hash of the encoded image is far cheaper than decoding it
+  std::string cache_path = get()->get_cache_path(image.name, directory, format);
+  uint64_t source_hash = 0;
+  if (!cache_path.empty()) {
+    source_hash = BakedTexture::hash(source.data, source.size);
+    if (image.baked.open(cache_path, source_hash, source.size, format)) {
+      return image;
+    }
+  }
+
+  image.surface = IMG_Load_RW(
+      SDL_RWFromConstMem(source.data, static_cast<int>(source.size)), 1);
+  if (image.surface == nullptr) {
+    LoggerManager::log_error("Could not load image " + image.name + ": " +
+                             IMG_GetError());
+    return image;
+  }
+
+  if (cache_path.empty()) {
+    return image;
+  }
+
+  // converted here rather than by the renderer, then baked for the next runs
+  SDL_Surface *converted = SDL_ConvertSurfaceFormat(image.surface, format, 0);
+  if (converted != nullptr) {
+    SDL_FreeSurface(image.surface);
+    image.surface = converted;
+    BakedTexture::bake(cache_path, image.surface, source_hash, source.size);
+  }
+  return image;
+}
+
+AssetPack::Data AssetManager::read_source(const std::string &name,
+                                          AssetDirectory directory,
+                                          std::vector<uint8_t> &buffer) {
+  AssetPack::Data data = get()->_pack.get_data(directory, name);
+  if (data.data != nullptr) {
+    return data;
+  }
+
+  std::string path =
+      std::string(ApplicationConfig::get_asset_path(directory)) + name;
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return {};
+  }
+
+  std::streamsize size = file.tellg();
+  if (size <= 0) {
+    return {};
+  }
+  file.seekg(0, std::ios::beg);
+
+  buffer.resize(static_cast<size_t>(size));
+  if (!file.read(reinterpret_cast<char *>(buffer.data()), size)) {
+    return {};
+  }
+  return {buffer.data(), buffer.size()};
+}
+
+void AssetManager::set_texture_cache(const std::string &path) {
+  _texture_cache_path = path;
+  _texture_format = SDL_PIXELFORMAT_UNKNOWN;
+  if (path.empty()) {
+    return;
+  }
+
+  // the first format listed by the renderer is the one it prefers
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(Application::get()->get_renderer(), &info) == 0) {
+    for (uint32_t i = 0; i < info.num_texture_formats; i++) {
+      uint32_t format = info.texture_formats[i];
+      if (!SDL_ISPIXELFORMAT_FOURCC(format) && SDL_ISPIXELFORMAT_ALPHA(format)) {
+        _texture_format = format;
+        break;
+      }
+    }
+  }
+
+  if (_texture_format == SDL_PIXELFORMAT_UNKNOWN) {
+    LoggerManager::log_warning(
+        "The renderer has no texture format to bake to, the texture cache is "
+        "disabled");
+  }
+}
+
+std::string AssetManager::get_cache_path(const std::string &name,
+                                         AssetDirectory directory,
+                                         uint32_t pixel_format) const {
+  // disabled, or no format to bake to
+  if (_texture_format == SDL_PIXELFORMAT_UNKNOWN ||
+      pixel_format == SDL_PIXELFORMAT_UNKNOWN) {
+    return "";
+  }
+
+  std::stringstream path;
+  path << _texture_cache_path << static_cast<int>(directory) << "/" << name
+       << "." << std::hex << pixel_format << ".pzt";
+  return path.str();
+}
+
+SDL_Texture *AssetManager::create_texture(DecodedImage &image,
+                                          SDL_Renderer *renderer) {
+  SDL_Texture *texture = nullptr;
+  if (image.baked.is_open()) {
+    texture = image.baked.upload(renderer);
+    image.baked.close();
+  } else if (image.surface != nullptr) {
+    texture = SDL_CreateTextureFromSurface(renderer, image.surface);
+    SDL_FreeSurface(image.surface);
+    image.surface = nullptr;
+  }
+
+  if (texture == nullptr) {
+    LoggerManager::log_error("Could not create a texture from " + image.name +
+                             ": " + SDL_GetError());
+  }
+  return texture;
+}
+
+bool AssetManager::mount_pack(const std::string &path) {
+  if (!_pack.open(path)) {
+    return false;
+  }
+
+  LoggerManager::log_info("Mounted asset pack " + path + " with " +
+                          std::to_string(_pack.get_entry_count()) +
+                          " assets");
+  return true;
+}
+
+bool AssetManager::has_asset(const std::string &name,
+                             AssetDirectory directory) {
+  if (get()->_pack.contains(directory, name)) {
+    return true;
+  }
+
+  std::error_code error;
+  return std::filesystem::exists(
+      std::string(ApplicationConfig::get_asset_path(directory)) + name, error);
+}
+
+SDL_Surface *AssetManager::load_image(const std::string &name,
+                                      AssetDirectory directory,
+                                      uint32_t pixel_format) {
+  if (!get()->get_cache_path(name, directory, pixel_format).empty()) {
+    DecodedImage image = decode(name, directory, pixel_format);
+    if (!image.baked.is_open()) {
+      return image.surface;
+    }
+
+    // copied out, the mapping is closed with the image
+    const BakedTexture &baked = image.baked;
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(
+        0, baked.get_width(), baked.get_height(),
+        SDL_BITSPERPIXEL(pixel_format), pixel_format);
+    if (surface == nullptr) {
+      LoggerManager::log_error("Could not create a surface for " + name +
+                               ": " + SDL_GetError());
+      return nullptr;
+    }
+
+    size_t row_size =
+        std::min<size_t>(surface->pitch, static_cast<size_t>(baked.get_pitch()));
+    for (int y = 0; y < baked.get_height(); y++) {
+      std::memcpy(static_cast<uint8_t *>(surface->pixels) + y * surface->pitch,
+                  baked.get_pixels() + y * baked.get_pitch(), row_size);
+    }
+    return surface;
+  }
+
+  AssetPack::Data data = get()->_pack.get_data(directory, name);
+
+  SDL_Surface *surface = nullptr;
+  if (data.data != nullptr) {
+    // decoded straight from the mapped pack
+    surface = IMG_Load_RW(
+        SDL_RWFromConstMem(data.data, static_cast<int>(data.size)), 1);
+  } else {
+    std::string path =
+        std::string(ApplicationConfig::get_asset_path(directory)) + name;
+    surface = IMG_Load(path.c_str());
+  }
+
+  if (surface == nullptr) {
+    LoggerManager::log_error("Could not load image " + name + ": " +
+                             IMG_GetError());
+  }
+  return surface;
+}
+
+void AssetManager::upload(DecodedImage &image) {
+  _streamed_pending--;
+  auto &slot = _streamed[image.name];
+
+  // the error was logged by the decoder
+  if (!image.is_valid()) {
+    slot->state = AssetState::FAILED;
+    return;
+  }
+
+  // loaded by get_texture() while it was streaming in
+  auto loaded = _textures.find(image.name);
+  if (loaded != _textures.end()) {
+    SDL_FreeSurface(image.surface);
+    slot->texture.store(loaded->second.texture, std::memory_order_release);
+    slot->state = AssetState::READY;
+    return;
+  }
+
+  SDL_Texture *texture =
+      create_texture(image, Application::get()->get_renderer());
+
+  if (texture == nullptr) {
+    slot->state = AssetState::FAILED;
+    return;
+  }
+
+  add_texture(image.name, texture, false);
+  slot->texture.store(texture, std::memory_order_release);
+  slot->state = AssetState::READY;
+}
+
+void AssetManager::add_texture(const std::string &name, SDL_Texture *texture,
+                               bool is_pinned) {
+  TextureEntry entry;
+  entry.texture = texture;
+  entry.last_use = _update_count;
+  entry.is_pinned = is_pinned;
+
+  Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
+  int width = 0;
+  int height = 0;
+  if (SDL_QueryTexture(texture, &format, nullptr, &width, &height) == 0) {
+    // compressed or unknown formats are counted as 4 bytes per pixel
+    size_t pixel_size = format == SDL_PIXELFORMAT_UNKNOWN
+                            ? 4
+                            : std::max<size_t>(SDL_BYTESPERPIXEL(format), 1);
+    entry.bytes = static_cast<size_t>(width) * height * pixel_size;
+  }
+
+  _texture_bytes += entry.bytes;
+  _textures[name] = entry;
+}
+
+void AssetManager::evict() {
+  std::vector<std::map<std::string, TextureEntry>::iterator> candidates;
+  for (auto it = _textures.begin(); it != _textures.end(); ++it) {
+    if (it->second.is_pinned) {
+      continue;
+    }
+
+    // only the manager refers to the slot, no handle is left
+    auto streamed = _streamed.find(it->first);
+    if (streamed != _streamed.end() && streamed->second.use_count() > 1) {
+      continue;
+    }
+    candidates.push_back(it);
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const auto &a, const auto &b) {
+              return a->second.last_use < b->second.last_use;
+            });
+
+  for (auto it : candidates) {
+    if (_texture_bytes <= _texture_budget) {
+      break;
+    }
+
+    SDL_DestroyTexture(it->second.texture);
+    _texture_bytes -= it->second.bytes;
+    _evicted_count++;
+
+    // the next request streams the image in again
+    _streamed.erase(it->first);
+    _textures.erase(it);
+  }
+}
@@ -2,11 +2,69 @@
 
 #include <core/config.h>
 #include <core/enums.h>
+#include <io/asset_pack.h>
+#include <io/baked_texture.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// shared between a handle and the asset manager loading it
+struct TextureSlot {
+  std::atomic<SDL_Texture *> texture = nullptr;
+  std::atomic<AssetState> state = AssetState::LOADING;
+};
+
+/**
+ * A texture that may still be streaming in. Until it is uploaded the handle
+ * gives the placeholder texture of the AssetManager, and keeps it if the
+ * texture cannot be loaded.
+ *
+ * Handles are reference counted, a texture is only evicted once no handle
+ * refers to it anymore.
+ */
+class TextureHandle {
+public:
+  TextureHandle() = default;
+  explicit TextureHandle(std::shared_ptr<TextureSlot> slot)
+      : _slot(std::move(slot)) {}
+
+  bool is_valid() const { return _slot != nullptr; }
+  bool is_ready() const {
+    return _slot != nullptr && _slot->state == AssetState::READY;
+  }
+  bool has_failed() const {
+    return _slot != nullptr && _slot->state == AssetState::FAILED;
+  }
+
+  // the texture once uploaded, the placeholder until then
+  SDL_Texture *get() const;
+
+private:
+  std::shared_ptr<TextureSlot> _slot;
+};
+
+struct AssetStats {
+  // estimated from the size and format of the textures
+  size_t texture_bytes = 0;
+  size_t texture_count = 0;
+  // decoded images waiting to be uploaded
+  size_t pending_bytes = 0;
+  size_t evicted_count = 0;
+};
 
 class AssetManager {
 public:
+  // decoded images uploaded per frame, in milliseconds
+  static constexpr double DEFAULT_UPLOAD_BUDGET = 2.0;
+  // no eviction until set
+  static constexpr size_t UNLIMITED_BUDGET = SIZE_MAX;
+
   AssetManager() = default;
-  ~AssetManager() = default;
+  ~AssetManager() { stop_streaming(); }
 
   static AssetManager *get() {
     static std::unique_ptr<AssetManager> instance =
@@ -16,18 +74,93 @@ public:
 
   void clean();
 
+  /**
+   * Load a texture right away, on first use. The texture is never evicted,
+   * the pointer stays valid until clean().
+   * @return null if the image cannot be loaded.
+   */
   static SDL_Texture *
   get_texture(const char *name,
               AssetDirectory directory = AssetDirectory::TEXTURES,
               SDL_Renderer *renderer = nullptr);
   static TTF_Font *get_font(const char *name, int size);
 
+  /**
+   * Read the assets from a pack rather than from the asset directories, the
+   * assets missing from it are still looked up as files.
+   * @return true if the pack was opened.
+   */
+  bool mount_pack(const std::string &path);
+  bool has_pack() const { return _pack.is_open(); }
+
+  // whether the asset is in the pack or in its directory
+  static bool has_asset(const std::string &name, AssetDirectory directory);
+
+  /**
+   * Decode an image from the pack or from its directory, safe from any
+   * thread.
+   * @param pixel_format Format to convert the image to, through the texture
+   * cache when enabled. Left as decoded when unknown.
+   * @return null if the image cannot be loaded, the error is logged.
+   */
+  static SDL_Surface *
+  load_image(const std::string &name, AssetDirectory directory,
+             uint32_t pixel_format = SDL_PIXELFORMAT_UNKNOWN);
+
+  /**
+   * Keep the decoded textures in a directory, in the pixel format of the
+   * renderer, and upload them from there while their source is unchanged.
+   * To be set before streaming starts, an empty path disables the cache.
+   */
+  void set_texture_cache(const std::string &path);
+
+  /**
+   * Load a texture in the background. The image is decoded on a streaming
+   * thread and uploaded by update(), the handle gives a placeholder until
+   * then. A texture already loaded is ready right away.
+   *
+   * Once the last handle is released the texture stays loaded until the
+   * budget is exceeded, it is then streamed in again on the next request.
+   */
+  static TextureHandle
+  request_texture(const char *name,
+                  AssetDirectory directory = AssetDirectory::TEXTURES);
+
+  /**
+   * Upload the images decoded since the last call, on the thread owning the
+   * renderer, once per frame. At least one image is uploaded per call. The
+   * least recently requested textures without handles are then evicted
+   * until the textures fit in the memory budget.
+   * @param budget_ms Time after which the remaining images wait for the next
+   * frame.
+   */
+  static void update(double budget_ms = DEFAULT_UPLOAD_BUDGET);
+
+  // start the decoding threads, 0 picks half of the cores
+  void start_streaming(size_t worker_count = 0);
+  // wait for the decoding threads, the requests left are dropped
+  void stop_streaming();
+
+  // drawn in place of the textures still streaming in, transparent by
+  // default
+  SDL_Texture *get_placeholder();
+  void set_placeholder(SDL_Texture *texture) { _placeholder = texture; }
+
+  size_t get_pending_count() const { return _streamed_pending; }
+
+  // bytes of texture memory kept, the textures still referenced are kept
+  // past it
+  void set_texture_budget(size_t bytes) { _texture_budget = bytes; }
+  size_t get_texture_budget() const { return _texture_budget; }
+
+  AssetStats get_stats();
+
   friend std::ostream &operator<<(std::ostream &os, const AssetManager &am) {
     // print in a json like fashion
     os << "{\n";
     os << "  \"textures\": {\n";
-    for (auto &[name, texture] : am._textures) {
-      os << "    \"" << name << "\": \"" << texture << "\",\n";
+    for (auto &[name, entry] : am._textures) {
+      os << "    \"" << name << "\": \"" << entry.texture << "\",\n";
     }
     os << "  },\n";
     os << "  \"fonts\": {\n";
@@ -41,6 +174,73 @@ public:
   }
 
 private:
-  std::map<std::string, SDL_Texture *> _textures;
+  struct TextureEntry {
+    SDL_Texture *texture = nullptr;
+    size_t bytes = 0;
+    // update() count of the last request, for the eviction order
+    uint64_t last_use = 0;
+    // handed out as a raw pointer by get_texture(), never evicted
+    bool is_pinned = false;
+  };
+
+  struct DecodeRequest {
+    std::string name;
+    AssetDirectory directory;
+  };
+
+  struct DecodedImage {
+    std::string name;
+    // mapped from the texture cache, or else decoded into the surface
+    BakedTexture baked;
+    // null if the image could not be decoded
+    SDL_Surface *surface = nullptr;
+
+    bool is_valid() const { return baked.is_open() || surface != nullptr; }
+  };
+
+  void run_decoder();
+  static DecodedImage decode(DecodeRequest request);
+  // the image mapped from the cache, or decoded and baked in the format
+  static DecodedImage decode(std::string name, AssetDirectory directory,
+                             uint32_t pixel_format);
+  // the encoded image, from the pack or read into the buffer
+  static AssetPack::Data read_source(const std::string &name,
+                                     AssetDirectory directory,
+                                     std::vector<uint8_t> &buffer);
+  std::string get_cache_path(const std::string &name, AssetDirectory directory,
+                             uint32_t pixel_format) const;
+  // free the pixels of the image once uploaded
+  static SDL_Texture *create_texture(DecodedImage &image,
+                                     SDL_Renderer *renderer);
+  void upload(DecodedImage &image);
+  void add_texture(const std::string &name, SDL_Texture *texture,
+                   bool is_pinned);
+  void evict();
+
+  std::map<std::string, TextureEntry> _textures;
   std::map<std::string, TTF_Font *> _fonts;
-};
\ No newline at end of file
+  AssetPack _pack;
+  std::string _texture_cache_path;
+  // format the cached textures are baked to, unknown when disabled
+  std::atomic<uint32_t> _texture_format = SDL_PIXELFORMAT_UNKNOWN;
+
+  // main thread only
+  std::map<std::string, std::shared_ptr<TextureSlot>> _streamed;
+  size_t _streamed_pending = 0;
+  SDL_Texture *_placeholder = nullptr;
+  bool _owns_placeholder = false;
+
+  size_t _texture_budget = UNLIMITED_BUDGET;
+  size_t _texture_bytes = 0;
+  size_t _evicted_count = 0;
+  uint64_t _update_count = 0;
+
+  // shared with the decoding threads
+  std::mutex _stream_mutex;
+  std::condition_variable _stream_condition;
+  std::deque<DecodeRequest> _decode_queue;
+  std::deque<DecodedImage> _decoded;
+  bool _is_stopping = false;
+
+  std::vector<std::thread> _decoders;
+};
@@ -0,0 +1,246 @@
+#include "logger_manager.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+void LoggerManager::init() {
+  auto *logger = get();
+  logger->clean();
+  {
+    std::lock_guard<std::mutex> lock(logger->_clean_mutex);
+    logger->_is_cleaned = false;
+  }
+
+  logger->_log_path =
+      "../cache/log_" +
+      format_time(std::chrono::system_clock::now(), "%Y-%m-%d %H:%M:%S") +
+      ".txt";
+
+  {
+    std::lock_guard<std::mutex> lock(logger->_write_mutex);
+    // opened once for the whole session
+    logger->_log_stream.open(logger->_log_path, std::ios_base::app);
+  }
+
+#if HAS_THREADS
+  logger->_is_stopping = false;
+  logger->_is_running = true;
+  logger->_writer = std::thread(&LoggerManager::run_writer, logger);
+#endif
+
+  log(LogLevel::INFO, "Session started.");
+}
+
+void LoggerManager::clean() {
+  // runs once, a second caller (two fatal messages) waits for the first
+  std::lock_guard<std::mutex> clean_lock(_clean_mutex);
+  if (_is_cleaned) {
+    return;
+  }
+  _is_cleaned = true;
+
+  // late callers write directly from here on, under the write mutex
+  _is_running = false;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_stopping = true;
+  }
+  _condition.notify_all();
+
+  if (_writer.joinable()) {
+    _writer.join();
+  }
+
+  // callers that still saw the logger running may be queueing
+  while (_producer_count > 0) {
+    std::this_thread::yield();
+  }
+
+  // queued before the switch but after the writer's last drain
+  std::vector<Record> records;
+  drain(records);
+  write(records);
+
+  std::lock_guard<std::mutex> lock(_write_mutex);
+  _log_stream.close();
+  _log_path.clear();
+}
+
+void LoggerManager::flush() {
+  if (!_is_running) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  size_t target = _pushed_count;
+  _wake = true;
+  _condition.notify_all();
+  _condition.wait(lock, [this, target] {
+    return _written_count >= target || !_is_running;
+  });
+}
+
+void LoggerManager::push(LogLevel level, std::string message) {
+  Record record = {std::chrono::system_clock::now(), level,
+                   std::move(message)};
+
+  // counted before checking _is_running, clean() waits for it to drop
+  _producer_count++;
+  if (!_is_running) {
+    write({std::move(record)});
+  } else if (_records.try_push(std::move(record))) {
+    _pushed_count++;
+    if (level >= LogLevel::ERROR) {
+      // shown without waiting for the next flush
+      _wake = true;
+      _condition.notify_one();
+    }
+  } else if (level >= LogLevel::ERROR) {
+    // errors are never dropped, written right away when the queue is full
+    write({std::move(record)});
+  } else {
+    _dropped++;
+    _dropped_total++;
+  }
+  _producer_count--;
+
+  if (level == LogLevel::FATAL) {
+    flush();
+    clean();
+    exit(EXIT_FAILURE);
+  }
+}
+
+void LoggerManager::run_writer() {
+  std::vector<Record> records;
+
+  while (true) {
+    bool is_stopping;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait_for(lock, FLUSH_INTERVAL, [this] {
+        return _is_stopping || _wake.exchange(false);
+      });
+      is_stopping = _is_stopping;
+    }
+
+    drain(records);
+
+    size_t dropped = _dropped.exchange(0);
+    if (dropped > 0) {
+      records.push_back({std::chrono::system_clock::now(), LogLevel::WARNING,
+                         std::to_string(dropped) +
+                             " log messages dropped, the queue was full"});
+    }
+
+    size_t written = records.size() - (dropped > 0 ? 1 : 0);
+    write(records);
+    records.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _written_count += written;
+    }
+    _condition.notify_all();
+
+    if (is_stopping) {
+      return;
+    }
+  }
+}
+
+void LoggerManager::drain(std::vector<Record> &records) {
+  Record record;
+  while (_records.try_pop(record)) {
+    records.push_back(std::move(record));
+  }
+}
+
+void LoggerManager::write(const std::vector<Record> &records) {
+  if (records.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_write_mutex);
+
+  // the whole batch is formatted first and written at once
+  std::string console;
+  std::string file;
+  for (const Record &record : records) {
+    std::string line = "[" + format_time(record.time, "%Y-%m-%d %H:%M:%S") +
+                       "] [" + get_log_level_string(record.level) + "] " +
+                       record.message + "\n";
+
+    if (record.level == LogLevel::FATAL) {
+      // the session ends with this message
+      line += "=== Session ended abnormally ===\n";
+    }
+
+    console += get_log_level_color(record.level);
+    console += line;
+    console += "\033[0m";
+    file += line;
+  }
+
+  std::cout << console << std::flush;
+
+  // logged before init(), in the default file
+  if (!_log_stream.is_open() && !_log_path.empty()) {
+    _log_stream.open(_log_path, std::ios_base::app);
+  }
+  if (_log_stream.is_open()) {
+    _log_stream << file;
+    _log_stream.flush();
+  }
+}
+
+std::string
+LoggerManager::format_time(std::chrono::system_clock::time_point time,
+                           const char *format) {
+  std::time_t time_t = std::chrono::system_clock::to_time_t(time);
+  std::tm tm = {};
+#ifdef _WIN32
+  localtime_s(&tm, &time_t);
+#else
+  localtime_r(&time_t, &tm);
+#endif
+
+  std::stringstream ss;
+  ss << std::put_time(&tm, format);
+  return ss.str();
+}
+
+const char *LoggerManager::get_log_level_string(LogLevel level) {
+  switch (level) {
+  case LogLevel::INFO:
+    return "INFO";
+  case LogLevel::WARNING:
+    return "WARNING";
+  case LogLevel::ERROR:
+    return "ERROR";
+  case LogLevel::FATAL:
+    return "FATAL";
+  }
+  return "UNKNOWN";
+}
+
+const char *LoggerManager::get_log_level_color(LogLevel level) {
+  switch (level) {
+  case LogLevel::INFO:
+    return "\033[0;34m";
+  case LogLevel::WARNING:
+    return "\033[0;33m";
+  case LogLevel::ERROR:
+    return "\033[0;31m";
+  case LogLevel::FATAL:
+    return "\033[0;31m";
+  }
+  return "\033[0m";
+}
@@ -2,20 +2,43 @@
 
 #pragma once
 
+#include <structs/mpsc_ring_buffer.h>
+
+#include <atomic>
 #include <chrono>
-#include <ctime>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 enum class LogLevel { INFO, WARNING, ERROR, FATAL };
 
+/**
+ * Logs to the console and to a file per session. Callers only turn the
+ * message into a string and push it to a lock-free queue, a background
+ * thread stamps and writes the queued records in batches to the file kept
+ * open, so logging from a hot path does not wait on the disk.
+ *
+ * Messages logged while the queue is full are dropped and counted, errors
+ * are written right away instead. A fatal message is written before the
+ * process exits. Messages logged before init()
+ * or without threads (wasm without pthreads) are written right away.
+ */
 class LoggerManager {
 public:
+  static constexpr size_t QUEUE_CAPACITY = 4096;
+  // the writer wakes up at least this often, errors wake it right away
+  static constexpr std::chrono::milliseconds FLUSH_INTERVAL{50};
+
+  LoggerManager() : _records(QUEUE_CAPACITY) {}
+  ~LoggerManager() { clean(); }
+
   /**
    * Get the singleton instance of LoggerManager.
    */
@@ -26,26 +49,20 @@ public:
   }
 
   /**
-   * Initialize the logger and create a new log file for the current session.
+   * Initialize the logger, create a new log file for the current session
+   * and start writing in the background.
    */
-  static void init() {
-    auto *logger = get();
-
-    logger->_log_path = "../cache/log_" + logger->get_current_time() + ".txt";
-
-    std::stringstream ss;
-    ss << "Session started." << std::endl;
+  static void init();
 
-    logger->log(LogLevel::INFO, ss.str());
-  }
+  /**
+   * Write the messages left and close the logger.
+   */
+  void clean();
 
   /**
-   * Clean up and close the logger.
+   * Wait until the messages logged so far are written.
    */
-  void clean() {
-    _log_stream.close();
-    _log_path.clear();
-  }
+  void flush();
 
   /**
    * Log a message with the specified log level.
@@ -53,18 +70,7 @@ public:
    * @param object The object to log.
    */
   template <typename T> static void log(LogLevel level, const T &object) {
-    auto *logger = get();
-
-    std::lock_guard<std::mutex> lock(logger->_log_mutex);
-
-    std::stringstream ss;
-    ss << "[" << logger->get_current_time() << "] ";
-    ss << "[" << logger->get_log_level_string(level) << "] ";
-    ss << object << std::endl;
-
-    std::cout << logger->get_log_level_color(level) << ss.str() << "\033[0m";
-
-    logger->_log(level, ss);
+    get()->push(level, to_string(object));
   }
 
   /**
@@ -99,93 +105,69 @@ public:
     log(LogLevel::WARNING, object);
   }
 
+  // messages lost to a full queue since the start
+  size_t get_dropped_count() const { return _dropped_total; }
+
 private:
-  /**
-   * Get the current time as a formatted string.
-   * @return The current time as a string.
-   */
-  std::string get_current_time() {
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    auto now_tm = std::localtime(&now_time_t);
-
-    std::stringstream ss;
-    ss << std::put_time(now_tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+  struct Record {
+    std::chrono::system_clock::time_point time;
+    LogLevel level = LogLevel::INFO;
+    std::string message;
+  };
+
+  template <typename T> static std::string to_string(const T &object) {
+    if constexpr (std::is_convertible_v<const T &, std::string>) {
+      return std::string(object);
+    } else {
+      std::stringstream ss;
+      ss << object;
+      return ss.str();
+    }
   }
 
+  void push(LogLevel level, std::string message);
+  void run_writer();
+  // write a batch to the console and the file, one thread at a time
+  void write(const std::vector<Record> &records);
+  // move the queued records to the batch, from the consumer only
+  void drain(std::vector<Record> &records);
+
   /**
-   * Get the string representation of a log level.
-   * @param level The log level.
-   * @return The string representation of the log level.
+   * Format a point in time in local time.
+   * @param format A std::put_time format.
    */
-  std::string get_log_level_string(LogLevel level) {
-    switch (level) {
-    case LogLevel::INFO:
-      return "INFO";
-    case LogLevel::WARNING:
-      return "WARNING";
-    case LogLevel::ERROR:
-      return "ERROR";
-    case LogLevel::FATAL:
-      return "FATAL";
-    }
-    return "UNKNOWN";
-  }
-
-  std::string get_log_level_color(LogLevel level) {
-    switch (level) {
-    case LogLevel::INFO:
-      return "\033[0;34m";
-    case LogLevel::WARNING:
-      return "\033[0;33m";
-    case LogLevel::ERROR:
-      return "\033[0;31m";
-    case LogLevel::FATAL:
-      return "\033[0;31m";
-    }
-    return "\033[0m";
-  }
+  static std::string format_time(std::chrono::system_clock::time_point time,
+                                 const char *format);
 
   /**
-   * Internal log function to handle writing logs to file and flushing the
-   * stream.
+   * Get the string representation of a log level.
    * @param level The log level.
-   * @param final_stream The final log message stream.
+   * @return The string representation of the log level.
    */
-  void _log(LogLevel level, const std::stringstream &final_stream) {
-    auto *logger = get();
-
-    // Write to file
-    if (!logger->_log_path.empty()) {
-      if (std::filesystem::exists(logger->_log_path)) {
-        logger->_log_stream.open(logger->_log_path, std::ios_base::app);
-      } else {
-        logger->_log_stream.open(logger->_log_path, std::ios_base::out);
-      }
-
-      logger->_log_stream << final_stream.str();
-
-      if (level == LogLevel::FATAL) {
-        logger->_log_stream << "=== Session ended abnormally ===" << std::endl;
-        std::cout << logger->get_log_level_color(level)
-                  << "=== Session ended abnormally ===" << std::endl
-                  << "\033[0m";
-      }
-
-      logger->_log_stream.close();
-    }
-
-    logger->_log_stream.flush();
-
-    if (level == LogLevel::FATAL) {
-      // add a message to the log file that the session ended
-      logger->clean();
-      exit(EXIT_FAILURE);
-    }
-  }
-
-  std::mutex _log_mutex;
+  static const char *get_log_level_string(LogLevel level);
+  static const char *get_log_level_color(LogLevel level);
+
+  MpscRingBuffer<Record> _records;
+  std::atomic<size_t> _pushed_count = 0;
+  std::atomic<size_t> _dropped = 0;
+  std::atomic<size_t> _dropped_total = 0;
+  // callers inside push(), between the _is_running check and the push
+  std::atomic<int> _producer_count = 0;
+
+  std::thread _writer;
+  std::atomic<bool> _is_running = false;
+  std::atomic<bool> _wake = false;
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _is_stopping = false;
+  // records written by the writer, for flush()
+  size_t _written_count = 0;
+
+  std::mutex _clean_mutex;
+  bool _is_cleaned = false;
+
+  // held while writing, by the writer or by the callers writing right away
+  std::mutex _write_mutex;
   std::ofstream _log_stream;
   std::filesystem::path _log_path = "../cache/log.txt";
 };
@@ -0,0 +1,156 @@
+#include "chunk_cache.h"
+
+ChunkCache &ChunkCache::operator=(ChunkCache &&other) noexcept {
+  if (this != &other) {
+    clear();
+
+    _chunks = std::move(other._chunks);
+    _columns = other._columns;
+    _rows = other._rows;
+    _chunk_size = other._chunk_size;
+    _baked_count = other._baked_count;
+    _is_supported = other._is_supported;
+
+    other._chunks.clear();
+    other._columns = other._rows = 0;
+  }
+  return *this;
+}
+
+void ChunkCache::reset(const Layer &layer) {
+  clear();
+
+  _columns = (layer.width + CHUNK_TILES - 1) / CHUNK_TILES;
+  _rows = (layer.height + CHUNK_TILES - 1) / CHUNK_TILES;
+  _chunk_size = CHUNK_TILES * layer.tile_size;
+  _chunks.resize(static_cast<size_t>(_columns) * _rows);
+}
+
+void ChunkCache::clear() {
+  for (auto &chunk : _chunks) {
+    if (chunk.texture != nullptr) {
+      SDL_DestroyTexture(chunk.texture);
+    }
+  }
+  _chunks.clear();
+  _baked_count = 0;
+}
+
+void ChunkCache::invalidate(int col, int row) {
+  int chunk_col = col / CHUNK_TILES;
+  int chunk_row = row / CHUNK_TILES;
+
+  if (col < 0 || row < 0 || chunk_col >= _columns || chunk_row >= _rows) {
+    return;
+  }
+  _chunks[chunk_row * _columns + chunk_col].dirty = true;
+}
+
+void ChunkCache::invalidate_all() {
+  for (auto &chunk : _chunks) {
+    chunk.dirty = true;
+  }
+}
+
+bool ChunkCache::render(SDL_Renderer *renderer, const Layer &layer,
+                        const Camera &camera) {
+  if (!_is_supported || _chunks.empty()) {
+    return false;
+  }
+
+  SDL_Rect view = camera.get_visible_rect();
+  int first_col = std::max(0, view.x / _chunk_size);
+  int first_row = std::max(0, view.y / _chunk_size);
+  int last_col = std::min(_columns - 1, (view.x + view.w) / _chunk_size);
+  int last_row = std::min(_rows - 1, (view.y + view.h) / _chunk_size);
+
+  for (int row = first_row; row <= last_row; row++) {
+    for (int col = first_col; col <= last_col; col++) {
+      Chunk &chunk = _chunks[row * _columns + col];
+
+      if (chunk.dirty && !bake(renderer, layer, col, row, chunk)) {
+        _is_supported = false;
+        return false;
+      }
+      if (chunk.empty) {
+        continue;
+      }
+
+      int width = 0;
+      int height = 0;
+      SDL_QueryTexture(chunk.texture, nullptr, nullptr, &width, &height);
+
+      SDL_Rect dst_rect = {col * _chunk_size - view.x,
+                           row * _chunk_size - view.y, width, height};
+      SDL_RenderCopy(renderer, chunk.texture, nullptr, &dst_rect);
+    }
+  }
+
+  return true;
+}
+
+bool ChunkCache::bake(SDL_Renderer *renderer, const Layer &layer,
+                      int chunk_col, int chunk_row, Chunk &chunk) {
+  int first_col = chunk_col * CHUNK_TILES;
+  int first_row = chunk_row * CHUNK_TILES;
+  int last_col = std::min(layer.width, first_col + CHUNK_TILES) - 1;
+  int last_row = std::min(layer.height, first_row + CHUNK_TILES) - 1;
+
+  chunk.dirty = false;
+  chunk.empty = true;
+  for (int row = first_row; row <= last_row && chunk.empty; row++) {
+    for (int col = first_col; col <= last_col; col++) {
+      if (layer.get_tile_id(row * layer.width + col) >= layer.first_gid) {
+        chunk.empty = false;
+        break;
+      }
+    }
+  }
+
+  if (chunk.empty) {
+    if (chunk.texture != nullptr) {
+      SDL_DestroyTexture(chunk.texture);
+      chunk.texture = nullptr;
+    }
+    return true;
+  }
+
+  if (chunk.texture == nullptr) {
+    if (!SDL_RenderTargetSupported(renderer)) {
+      LoggerManager::log_warning(
+          "Render targets are not supported, drawing layers tile by tile");
+      return false;
+    }
+
+    // edge chunks only cover the tiles left
+    int width = (last_col - first_col + 1) * layer.tile_size;
+    int height = (last_row - first_row + 1) * layer.tile_size;
+    chunk.texture =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                          SDL_TEXTUREACCESS_TARGET, width, height);
+
+    if (chunk.texture == nullptr) {
+      LoggerManager::log_warning("Could not create chunk texture: " +
+                                 std::string(SDL_GetError()));
+      return false;
+    }
+    SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+  }
+
+  SDL_Texture *previous_target = SDL_GetRenderTarget(renderer);
+  Uint8 r, g, b, a;
+  SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+  SDL_SetRenderTarget(renderer, chunk.texture);
+  // transparent so that the layers below show through
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  layer.render_tiles(renderer, first_col, first_row, last_col, last_row,
+                     first_col * layer.tile_size, first_row * layer.tile_size);
+
+  SDL_SetRenderTarget(renderer, previous_target);
+  SDL_SetRenderDrawColor(renderer, r, g, b, a);
+
+  _baked_count++;
+  return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "layer.h"
+
+/**
+ * Tiles of a layer pre-rendered into chunk textures. A chunk is baked the
+ * first time it comes into view and kept until one of its tiles changes, so
+ * drawing a static layer costs one copy per visible chunk instead of one per
+ * tile.
+ */
+class ChunkCache {
+public:
+  // size of a chunk, in tiles
+  static constexpr int CHUNK_TILES = 16;
+
+  ChunkCache() = default;
+  ~ChunkCache() { clear(); }
+
+  ChunkCache(const ChunkCache &) = delete;
+  ChunkCache &operator=(const ChunkCache &) = delete;
+  ChunkCache(ChunkCache &&other) noexcept { *this = std::move(other); }
+  ChunkCache &operator=(ChunkCache &&other) noexcept;
+
+  // prepare the chunks of a layer, releasing the previous ones
+  void reset(const Layer &layer);
+  // destroy every chunk texture
+  void clear();
+
+  // rebuild the chunk holding the tile at the given position
+  void invalidate(int col, int row);
+  // rebuild every chunk, needed when the renderer lost its render targets
+  void invalidate_all();
+
+  /**
+   * Draw the visible chunks of the layer, baking the missing ones.
+   * @return false if the chunks cannot be baked with this renderer, the layer
+   * has to be drawn tile by tile then.
+   */
+  bool render(SDL_Renderer *renderer, const Layer &layer,
+              const Camera &camera);
+
+  int get_baked_count() const { return _baked_count; }
+
+private:
+  struct Chunk {
+    SDL_Texture *texture = nullptr;
+    bool dirty = true;
+    // no tile to draw, nothing is baked
+    bool empty = false;
+  };
+
+  bool bake(SDL_Renderer *renderer, const Layer &layer, int chunk_col,
+            int chunk_row, Chunk &chunk);
+
+  std::vector<Chunk> _chunks;
+  int _columns = 0;
+  int _rows = 0;
+  int _chunk_size = 0; // in pixels
+  int _baked_count = 0;
+  bool _is_supported = true;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Binary layout of a cooked map (.pzm), written by MapSerializer::cook and
+ * used in place once mapped in memory. All values are little endian.
+ *
+ *   CookedMapHeader
+ *   CookedTileset[tileset_count]
+ *   CookedLayer[layer_count]
+ *   uint16_t tile ids of every layer, each block aligned on 8 bytes
+ */
+namespace CookedMap {
+
+constexpr char MAGIC[4] = {'P', 'Z', 'M', 'P'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t NAME_SIZE = 64;
+constexpr uint32_t PATH_SIZE = 192;
+constexpr uint32_t DATA_ALIGNMENT = 8;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t tile_size;
+  uint32_t tileset_count;
+  uint32_t layer_count;
+  uint32_t reserved;
+  char name[NAME_SIZE];
+};
+
+struct Tileset {
+  uint32_t first_gid;
+  uint32_t tile_width;
+  uint32_t tile_height;
+  uint32_t tile_count;
+  uint32_t columns;
+  uint32_t image_width;
+  uint32_t image_height;
+  uint32_t reserved;
+  char name[NAME_SIZE];
+  char image_source[PATH_SIZE];
+};
+
+struct Layer {
+  char name[NAME_SIZE];
+  uint32_t type;
+  uint32_t visible;
+  uint32_t width;
+  uint32_t height;
+  uint32_t first_gid;
+  uint32_t columns;
+  uint64_t data_offset; // from the start of the file
+};
+
+static_assert(sizeof(Header) % DATA_ALIGNMENT == 0);
+static_assert(sizeof(Tileset) % DATA_ALIGNMENT == 0);
+static_assert(sizeof(Layer) % DATA_ALIGNMENT == 0);
+
+} // namespace CookedMap
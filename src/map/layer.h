@@ -1,24 +1,116 @@
 #pragma once
 
-#include "tile.h"
+#include <camera/camera.h>
+#include <core/config.h>
+#include <core/enums.h>
+#include <managers/logger/logger_manager.h>
+#include <structs/my_vector.h>
 
 struct Layer {
 
-  Layer(const char *name, LayerType type, SDL_Texture *texture, int width,
-        int height, int tile_size, std::vector<Tile> data)
-      : name(name), type(type), texture(texture), width(width), height(height),
-        tile_size(tile_size), data(data) {}
+  Layer(const std::string &name, LayerType type, SDL_Texture *texture,
+        int width, int height, int tile_size, std::vector<uint16_t> ids)
+      : name(name), type(type), width(width), height(height),
+        tile_size(tile_size), texture(texture), ids(std::move(ids)) {}
 
-  const char *name;
+  std::string name;
   LayerType type;
   int width;
   int height;
   int tile_size;
   SDL_Texture *texture = nullptr;
+  bool visible = true;
 
-  std::vector<Tile> data;
+  // tileset of the layer, used to find a tile in the texture
+  int first_gid = 1;
+  int columns = 1;
 
-  void render(SDL_Renderer *renderer) {
+  // tile ids, row by row, the coordinates of a tile come from its index
+  std::vector<uint16_t> ids;
+
+  // tile ids used in place when the layer comes from a cooked map, `ids` is
+  // left empty in that case
+  const uint16_t *mapped_ids = nullptr;
+
+  // optional planes, only allocated once a tile of the layer sets them
+  std::vector<TileType> types;
+  std::vector<uint16_t> costs;
+  std::vector<uint16_t> heuristics;
+
+  size_t get_tile_count() const {
+    return static_cast<size_t>(width) * height;
+  }
+  size_t get_index(int col, int row) const {
+    return static_cast<size_t>(row) * width + col;
+  }
+  Vector2i get_coords(size_t index) const {
+    return {static_cast<int>(index % width), static_cast<int>(index / width)};
+  }
+
+  int get_tile_id(size_t index) const {
+    return mapped_ids != nullptr ? mapped_ids[index] : ids[index];
+  }
+
+  // change a tile, a cooked layer gets its own copy of the ids first
+  void set_tile_id(size_t index, uint16_t id) {
+    if (mapped_ids != nullptr) {
+      ids.assign(mapped_ids, mapped_ids + get_tile_count());
+      mapped_ids = nullptr;
+    }
+    ids[index] = id;
+  }
+
+  // without a type plane, the type follows from the layer type
+  TileType get_tile_type(size_t index) const {
+    if (!types.empty()) {
+      return types[index];
+    }
+    return get_derived_tile_type(index);
+  }
+
+  TileType get_derived_tile_type(size_t index) const {
+    if (get_tile_id(index) == 0) {
+      return TileType::NONE;
+    }
+    return type == OBSTACLE_LAYER ? TileType::WALL : TileType::FLOOR;
+  }
+
+  void set_tile_type(size_t index, TileType tile_type) {
+    if (types.empty()) {
+      // derived while the plane is still empty, the other tiles keep their
+      // type
+      std::vector<TileType> derived(get_tile_count());
+      for (size_t i = 0; i < derived.size(); i++) {
+        derived[i] = get_derived_tile_type(i);
+      }
+      types = std::move(derived);
+    }
+    types[index] = tile_type;
+  }
+
+  int get_tile_cost(size_t index) const {
+    return costs.empty() ? 0 : costs[index];
+  }
+
+  void set_tile_cost(size_t index, uint16_t cost) {
+    if (costs.empty()) {
+      costs.resize(get_tile_count());
+    }
+    costs[index] = cost;
+  }
+
+  int get_tile_heuristic(size_t index) const {
+    return heuristics.empty() ? 0 : heuristics[index];
+  }
+
+  void set_tile_heuristic(size_t index, uint16_t heuristic) {
+    if (heuristics.empty()) {
+      heuristics.resize(get_tile_count());
+    }
+    heuristics[index] = heuristic;
+  }
+
+  void render(SDL_Renderer *renderer, const Camera &camera) {
     if (renderer == nullptr) {
       LoggerManager::log_error("SDL_Renderer is null");
       std::cerr << "SDL_Renderer is null" << std::endl;
@@ -31,24 +123,47 @@ struct Layer {
       exit(EXIT_FAILURE);
     }
 
+    // only walk the tiles overlapping the camera view
+    SDL_Rect view = camera.get_visible_rect();
+    int first_col = std::max(0, view.x / tile_size);
+    int first_row = std::max(0, view.y / tile_size);
+    int last_col = std::min(width - 1, (view.x + view.w) / tile_size);
+    int last_row = std::min(height - 1, (view.y + view.h) / tile_size);
+
+    render_tiles(renderer, first_col, first_row, last_col, last_row, view.x,
+                 view.y);
+  }
+
+  /**
+   * Draw a range of tiles, bounds included.
+   * @param origin_x, origin_y The position in the layer drawn at (0, 0).
+   * @return The number of tiles drawn.
+   */
+  int render_tiles(SDL_Renderer *renderer, int first_col, int first_row,
+                   int last_col, int last_row, int origin_x,
+                   int origin_y) const {
     SDL_Rect src_rect;
     SDL_Rect dst_rect;
 
     src_rect.w = src_rect.h = dst_rect.w = dst_rect.h = tile_size;
 
-    for (int row = 0; row < height; row++) {
-      dst_rect.y = row * tile_size;
+    int count = 0;
+    for (int row = first_row; row <= last_row; row++) {
+      dst_rect.y = row * tile_size - origin_y;
 
-      for (int col = 0; col < width; col++) {
-        dst_rect.x = col * tile_size;
+      for (int col = first_col; col <= last_col; col++) {
+        dst_rect.x = col * tile_size - origin_x;
 
-        uint16_t tile_id = data[(row * width) + col].get_id();
+        int local_id = get_tile_id((row * width) + col) - first_gid;
 
-        if (tile_id != 0) {
-          src_rect.x = (tile_id - 1) * tile_size;
+        if (local_id >= 0) {
+          src_rect.x = (local_id % columns) * tile_size;
+          src_rect.y = (local_id / columns) * tile_size;
           SDL_RenderCopy(renderer, texture, &src_rect, &dst_rect);
+          count++;
         }
       }
     }
+    return count;
   }
 };
@@ -1,19 +1,231 @@
 #include "map.h"
+#include "serializer.h"
+#include <managers/asset/asset_manager.h>
 
-void Map::load(const char *name) {
-  // TODO: implement
+#include <filesystem>
 
+namespace {
+
+const char *COOKED_EXTENSION = ".pzm";
+
+bool has_extension(const std::string &path, const char *extension) {
+  return std::filesystem::path(path).extension() == extension;
+}
+
+// the cooked sibling of a .tmx map, when it is at least as recent as it
+bool find_cooked(const std::string &path, std::string &cooked_path) {
+  std::filesystem::path cooked =
+      std::filesystem::path(path).replace_extension(COOKED_EXTENSION);
+
+  std::error_code error;
+  auto cooked_time = std::filesystem::last_write_time(cooked, error);
+  if (error) {
+    return false;
+  }
+  auto source_time = std::filesystem::last_write_time(path, error);
+  if (!error && source_time > cooked_time) {
+    LoggerManager::log_warning("Cooked map " + cooked.string() +
+                               " is older than its source, ignoring it");
+    return false;
+  }
+
+  cooked_path = cooked.string();
+  return true;
+}
+
+} // namespace
+
+bool Map::load(const char *name) {
+  if (!load_data(name)) {
+    return false;
+  }
+
+  load_textures();
+  return true;
+}
+
+bool Map::load_data(const char *name) {
   LoggerManager::log_info("Loading map: " + std::string(name));
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::string path = ApplicationConfig::map_path + name;
+  std::unique_ptr<MapConfig> config = load_config(path);
+
+  if (config == nullptr) {
+    LoggerManager::log_error("Could not load map " + path);
+    return false;
+  }
+
+  _config = std::move(config);
+
+  _chunk_caches.resize(_config->layers.size());
+  for (size_t i = 0; i < _config->layers.size(); i++) {
+    _chunk_caches[i].reset(_config->layers[i]);
+  }
+
+  _nav_grid.build(_config->layers, _config->width, _config->height);
+  _nav_snapshot.reset();
+  _pathfinder.reserve(_nav_grid.get_size());
+  _flow_fields.invalidate();
+
+  auto elapsed = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start);
+
+  LoggerManager::log_info(
+      "Loaded map " + std::string(name) + " (" +
+      std::to_string(_config->width) + "x" + std::to_string(_config->height) +
+      ", " + std::to_string(_config->layers.size()) + " layers) in " +
+      std::to_string(elapsed.count()) + "ms");
+
+  return true;
+}
+
+std::unique_ptr<MapConfig> Map::load_config(const std::string &path) {
+  // the layers of the previous map may still point into the mapping
+  _chunk_caches.clear();
+  _config.reset();
+  _mapped_file.close();
+
+  std::string cooked_path;
+  if (has_extension(path, COOKED_EXTENSION)) {
+    cooked_path = path;
+  } else if (!find_cooked(path, cooked_path)) {
+    return MapSerializer::load_tmx(path);
+  }
+
+  if (!_mapped_file.open(cooked_path)) {
+    LoggerManager::log_error("Could not map file " + cooked_path);
+    return nullptr;
+  }
+
+  return MapSerializer::load_cooked(_mapped_file);
+}
+
+void Map::load_textures() {
+  if (_config == nullptr) {
+    return;
+  }
+
+  for (auto &tileset : _config->tilesets) {
+    if (tileset.image_source.empty()) {
+      continue;
+    }
+
+    // the map may reference the image anywhere on the author's disk, only
+    // its file name is looked up in the tilesets directory
+    std::string file_name =
+        std::filesystem::path(tileset.image_source).filename().string();
+    if (!AssetManager::has_asset(file_name, AssetDirectory::TILESETS)) {
+      LoggerManager::log_warning("Tileset image " + file_name +
+                                 " not found, the layers using tileset " +
+                                 tileset.name + " will not be drawn");
+      continue;
+    }
+
+    // the layers are drawn once their image is uploaded
+    tileset.handle = AssetManager::request_texture(file_name.c_str(),
+                                                   AssetDirectory::TILESETS);
+  }
+
+  update_textures();
+}
+
+void Map::update_textures() {
+  if (_config == nullptr) {
+    return;
+  }
+
+  bool changed = false;
+  for (auto &tileset : _config->tilesets) {
+    if (tileset.texture == nullptr && tileset.handle.is_ready()) {
+      tileset.texture = tileset.handle.get();
+      changed = true;
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  for (auto &layer : _config->layers) {
+    for (const auto &tileset : _config->tilesets) {
+      if (tileset.first_gid == layer.first_gid) {
+        layer.texture = tileset.texture;
+        break;
+      }
+    }
+  }
 }
 
-void Map::render(SDL_Renderer *renderer) {
+bool Map::is_renderable() const {
+  if (_config == nullptr) {
+    return false;
+  }
+
+  for (const auto &layer : _config->layers) {
+    if (layer.texture != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Map::render(SDL_Renderer *renderer, const Camera &camera) {
   if (renderer == nullptr) {
     LoggerManager::log_error("SDL_Renderer is null");
     std::cerr << "SDL_Renderer is null" << std::endl;
     exit(EXIT_FAILURE);
   }
 
-  for (auto &[name, layer] : _config->layers) {
-    layer.render(renderer);
+  if (_config == nullptr) {
+    return;
+  }
+
+  update_textures();
+
+  for (size_t i = 0; i < _config->layers.size(); i++) {
+    Layer &layer = _config->layers[i];
+
+    // layers whose tileset image is missing cannot be drawn
+    if (layer.texture == nullptr || !layer.visible) {
+      continue;
+    }
+
+    if (!_use_chunk_cache || !_chunk_caches[i].render(renderer, layer, camera)) {
+      layer.render(renderer, camera);
+    }
+  }
+}
+
+bool Map::set_tile(const char *layer_name, int col, int row, uint16_t id) {
+  if (!layer_name || !_config) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _config->layers.size(); i++) {
+    Layer &layer = _config->layers[i];
+    if (layer.name != layer_name) {
+      continue;
+    }
+
+    if (col < 0 || row < 0 || col >= layer.width || row >= layer.height) {
+      return false;
+    }
+
+    layer.set_tile_id(layer.get_index(col, row), id);
+    _chunk_caches[i].invalidate(col, row);
+    if (_nav_grid.update(_config->layers, col, row)) {
+      _nav_snapshot.reset();
+      _flow_fields.invalidate();
+    }
+    return true;
+  }
+  return false;
+}
+
+void Map::invalidate_chunks() {
+  for (auto &cache : _chunk_caches) {
+    cache.invalidate_all();
   }
 }
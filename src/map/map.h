@@ -1,18 +1,25 @@
 #pragma once
 
+#include "chunk_cache.h"
 #include "layer.h"
+#include "tileset.h"
+#include <io/mapped_file.h>
+#include <pathfinding/flow_field.h>
+#include <pathfinding/pathfinder.h>
 
 struct MapConfig {
 
-  MapConfig(const char *name, int width, int height, int tile_size)
+  MapConfig(const std::string &name, int width, int height, int tile_size)
       : name(name), width(width), height(height), tile_size(tile_size) {}
 
-  const char *name;
+  std::string name;
   int width;
   int height;
   int tile_size;
 
-  std::map<std::string, Layer> layers;
+  std::vector<Tileset> tilesets;
+  // in drawing order, from the bottom to the top
+  std::vector<Layer> layers;
 };
 
 class Map {
@@ -25,21 +32,99 @@ public:
     return instance.get();
   }
 
-  void load(const char *name);
-  void render(SDL_Renderer *renderer);
+  /**
+   * Load a map from the maps asset directory. A .tmx map is read from its
+   * cooked .pzm sibling when that one is up to date.
+   * @param name The file name of the map, a Tiled .tmx or a cooked .pzm file.
+   * @return true if the map was loaded.
+   */
+  bool load(const char *name);
+  /**
+   * Load a map without its textures, safe off the renderer thread. Its
+   * layers are drawn once load_textures() is called.
+   */
+  bool load_data(const char *name);
+  // request the tileset images and hand them to the layers drawn with them
+  void load_textures();
+  void render(SDL_Renderer *renderer, const Camera &camera);
+
+  bool is_loaded() const { return _config != nullptr; }
+  // whether at least one layer has a texture to be drawn with
+  bool is_renderable() const;
+  // pick up the tileset images uploaded since the last call
+  void update_textures();
 
   int get_width() const { return _config->width; }
   int get_height() const { return _config->height; }
   int get_tile_size() const { return _config->tile_size; }
 
   Layer *get_layer(const char *name) {
-    if (!name)
-      return NULL;
-    if (_config->layers.find(name) == _config->layers.end())
+    if (!name || !_config)
       return NULL;
-    return &_config->layers.at(name);
+    for (auto &layer : _config->layers) {
+      if (layer.name == name)
+        return &layer;
+    }
+    return NULL;
+  }
+
+  std::vector<Layer> &get_layers() { return _config->layers; }
+
+  /**
+   * Change a tile of a layer, its cached chunk is rebuilt when next drawn.
+   * @return false if the layer or the position does not exist.
+   */
+  bool set_tile(const char *layer_name, int col, int row, uint16_t id);
+
+  // walkability of the tiles, kept in sync with the obstacle layers
+  const NavGrid &get_nav_grid() const { return _nav_grid; }
+
+  // an immutable copy of the grid for other threads, renewed after a change
+  std::shared_ptr<const NavGrid> get_nav_snapshot() {
+    if (_nav_snapshot == nullptr) {
+      _nav_snapshot = std::make_shared<const NavGrid>(_nav_grid);
+    }
+    return _nav_snapshot;
+  }
+
+  /**
+   * Find a path between two tiles, avoiding the walls of the obstacle layers.
+   * @param path Filled with the tiles to walk through, the goal included.
+   * @return true if the goal can be reached.
+   */
+  bool find_path(Vector2i start, Vector2i goal, std::vector<Vector2i> &path) {
+    return _pathfinder.find_path(_nav_grid, start, goal, path);
+  }
+
+  /**
+   * Directions towards a goal tile for every tile of the map, shared by all
+   * the walkers heading there. Fields are cached per goal and rebuilt after a
+   * tile change alters the walkability or the costs of the grid.
+   * @return null if the goal is out of the map or blocked.
+   */
+  std::shared_ptr<const FlowField> get_flow_field(Vector2i goal) {
+    return _flow_fields.get(_nav_grid, goal);
   }
+  FlowFieldCache &get_flow_field_cache() { return _flow_fields; }
+
+  // draw the layers from cached chunk textures rather than tile by tile
+  void set_chunk_caching(bool enabled) { _use_chunk_cache = enabled; }
+  // the chunk textures are lost with the render targets of the renderer
+  void invalidate_chunks();
 
 private:
+  std::unique_ptr<MapConfig> load_config(const std::string &path);
+
   std::unique_ptr<MapConfig> _config = nullptr;
-};
\ No newline at end of file
+  // backs the tile ids of the layers of a cooked map
+  MappedFile _mapped_file;
+
+  NavGrid _nav_grid;
+  std::shared_ptr<const NavGrid> _nav_snapshot = nullptr;
+  Pathfinder _pathfinder;
+  FlowFieldCache _flow_fields;
+
+  // one per layer, in the same order
+  std::vector<ChunkCache> _chunk_caches;
+  bool _use_chunk_cache = true;
+};
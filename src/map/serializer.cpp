@@ -0,0 +1,669 @@
+#include "serializer.h"
+#include "cooked_map.h"
+#include <managers/logger/logger_manager.h>
+#include <utils/string_utils.h>
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+// the upper bits of a gid hold the flip flags of the tile
+constexpr uint32_t GID_MASK = 0x1FFFFFFF;
+
+// A single XML tag, views point into the source text.
+struct XmlTag {
+  static constexpr size_t MAX_ATTRIBUTES = 16;
+
+  std::string_view name;
+  std::array<std::pair<std::string_view, std::string_view>, MAX_ATTRIBUTES>
+      attributes;
+  size_t attribute_count = 0;
+  bool closing = false;
+  bool self_closing = false;
+
+  std::string_view get(std::string_view key) const {
+    for (size_t i = 0; i < attribute_count; i++) {
+      if (attributes[i].first == key) {
+        return attributes[i].second;
+      }
+    }
+    return {};
+  }
+
+  bool has(std::string_view key) const {
+    for (size_t i = 0; i < attribute_count; i++) {
+      if (attributes[i].first == key) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int get_int(std::string_view key, int default_value = 0) const {
+    std::string_view value = get(key);
+    int result = default_value;
+    std::from_chars(value.data(), value.data() + value.size(), result);
+    return result;
+  }
+};
+
+// Forward only tag scanner, enough of XML for the files written by Tiled.
+class XmlReader {
+public:
+  explicit XmlReader(std::string_view text) : _text(text) {}
+
+  // move to the next element tag, skipping text, comments and declarations
+  bool next_tag(XmlTag &tag) {
+    while (true) {
+      _pos = _text.find('<', _pos);
+      if (_pos == std::string_view::npos) {
+        _pos = _text.size();
+        return false;
+      }
+
+      if (_text.compare(_pos, 4, "<!--") == 0) {
+        _pos = _text.find("-->", _pos);
+        if (_pos == std::string_view::npos) {
+          _pos = _text.size();
+          return false;
+        }
+        _pos += 3;
+        continue;
+      }
+
+      if (_pos + 1 < _text.size() &&
+          (_text[_pos + 1] == '?' || _text[_pos + 1] == '!')) {
+        _pos = _text.find('>', _pos);
+        if (_pos == std::string_view::npos) {
+          _pos = _text.size();
+          return false;
+        }
+        _pos++;
+        continue;
+      }
+
+      return read_tag(tag);
+    }
+  }
+
+  // the text between the current position and the next tag
+  std::string_view text_until_tag() const {
+    size_t end = _text.find('<', _pos);
+    if (end == std::string_view::npos) {
+      end = _text.size();
+    }
+    return _text.substr(_pos, end - _pos);
+  }
+
+private:
+  bool read_tag(XmlTag &tag) {
+    tag = XmlTag();
+    _pos++; // '<'
+
+    if (_pos < _text.size() && _text[_pos] == '/') {
+      tag.closing = true;
+      _pos++;
+    }
+
+    tag.name = read_name();
+
+    while (_pos < _text.size()) {
+      skip_spaces();
+      if (_pos >= _text.size()) {
+        return false;
+      }
+
+      char c = _text[_pos];
+      if (c == '>') {
+        _pos++;
+        return true;
+      }
+      if (c == '/') {
+        tag.self_closing = true;
+        _pos++;
+        continue;
+      }
+
+      std::string_view key = read_name();
+      if (key.empty()) {
+        // malformed attribute, give up on the rest of the tag
+        _pos = _text.find('>', _pos);
+        if (_pos == std::string_view::npos) {
+          _pos = _text.size();
+          return false;
+        }
+        _pos++;
+        return true;
+      }
+
+      skip_spaces();
+      std::string_view value;
+      if (_pos < _text.size() && _text[_pos] == '=') {
+        _pos++;
+        skip_spaces();
+        value = read_quoted();
+      }
+
+      if (tag.attribute_count < XmlTag::MAX_ATTRIBUTES) {
+        tag.attributes[tag.attribute_count++] = {key, value};
+      }
+    }
+
+    return false;
+  }
+
+  std::string_view read_name() {
+    size_t start = _pos;
+    while (_pos < _text.size()) {
+      char c = _text[_pos];
+      if (std::isspace(static_cast<unsigned char>(c)) || c == '=' ||
+          c == '>' || c == '/') {
+        break;
+      }
+      _pos++;
+    }
+    return _text.substr(start, _pos - start);
+  }
+
+  std::string_view read_quoted() {
+    if (_pos >= _text.size()) {
+      return {};
+    }
+
+    char quote = _text[_pos];
+    if (quote != '"' && quote != '\'') {
+      return read_name();
+    }
+
+    size_t start = ++_pos;
+    size_t end = _text.find(quote, start);
+    if (end == std::string_view::npos) {
+      end = _text.size();
+    }
+    _pos = std::min(end + 1, _text.size());
+    return _text.substr(start, end - start);
+  }
+
+  void skip_spaces() {
+    while (_pos < _text.size() &&
+           std::isspace(static_cast<unsigned char>(_text[_pos]))) {
+      _pos++;
+    }
+  }
+
+  std::string_view _text;
+  size_t _pos = 0;
+};
+
+void set_tile(std::vector<uint16_t> &ids, size_t index, uint32_t gid) {
+  if (index >= ids.size()) {
+    return;
+  }
+
+  gid &= GID_MASK;
+  if (gid > UINT16_MAX) {
+    LoggerManager::log_warning("Tile id " + std::to_string(gid) +
+                               " does not fit in 16 bits, the tile is dropped");
+    gid = 0;
+  }
+  ids[index] = static_cast<uint16_t>(gid);
+}
+
+bool read_file(const std::string &file_path, std::string &content) {
+  std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::streamsize size = file.tellg();
+  file.seekg(0, std::ios::beg);
+
+  content.resize(size);
+  return static_cast<bool>(file.read(content.data(), size));
+}
+
+// layers meant for collisions are flagged with a "type" or "obstacle"
+// property, or named after it
+bool is_obstacle_layer_name(const std::string &name) {
+  std::string lower_name = StringUtils::to_lower(name);
+  return lower_name.find("obstacle") != std::string::npos ||
+         lower_name.find("collision") != std::string::npos;
+}
+
+// attach every layer to the tileset of its first tile
+void assign_layer_tilesets(MapConfig &config) {
+  for (auto &layer : config.layers) {
+    const Tileset *layer_tileset = nullptr;
+
+    for (uint16_t id : layer.ids) {
+      if (id == 0) {
+        continue;
+      }
+
+      const Tileset *tileset = nullptr;
+      for (const auto &candidate : config.tilesets) {
+        if (candidate.first_gid <= id &&
+            (tileset == nullptr || candidate.first_gid > tileset->first_gid)) {
+          tileset = &candidate;
+        }
+      }
+
+      if (layer_tileset == nullptr) {
+        layer_tileset = tileset;
+      } else if (tileset != layer_tileset) {
+        LoggerManager::log_warning("Layer " + layer.name +
+                                   " uses several tilesets, only " +
+                                   layer_tileset->name + " will be drawn");
+        break;
+      }
+    }
+
+    if (layer_tileset == nullptr) {
+      continue;
+    }
+
+    layer.first_gid = layer_tileset->first_gid;
+    layer.columns = std::max(layer_tileset->columns, 1);
+  }
+}
+
+void copy_string(char *destination, size_t size, const std::string &source) {
+  std::memset(destination, 0, size);
+  std::memcpy(destination, source.data(), std::min(source.size(), size - 1));
+}
+
+std::string read_string(const char *source, size_t size) {
+  return std::string(source, strnlen(source, size));
+}
+
+size_t align(size_t offset) {
+  return (offset + CookedMap::DATA_ALIGNMENT - 1) &
+         ~static_cast<size_t>(CookedMap::DATA_ALIGNMENT - 1);
+}
+
+} // namespace
+
+size_t MapSerializer::decode_csv(std::string_view text,
+                                 std::vector<uint16_t> &ids) {
+  size_t count = 0;
+  uint32_t value = 0;
+  bool in_number = false;
+
+  for (char c : text) {
+    if (c >= '0' && c <= '9') {
+      value = value * 10 + static_cast<uint32_t>(c - '0');
+      in_number = true;
+      continue;
+    }
+
+    if (c == '<') {
+      break;
+    }
+
+    if (in_number) {
+      set_tile(ids, count++, value);
+      value = 0;
+      in_number = false;
+    }
+  }
+
+  if (in_number) {
+    set_tile(ids, count++, value);
+  }
+
+  return count;
+}
+
+size_t MapSerializer::decode_base64(std::string_view text,
+                                    std::vector<uint16_t> &ids) {
+  static const std::array<int8_t, 256> lookup = [] {
+    std::array<int8_t, 256> table;
+    table.fill(-1);
+    const char *alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < 64; i++) {
+      table[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+    }
+    return table;
+  }();
+
+  size_t count = 0;
+  uint32_t bits = 0;
+  int bit_count = 0;
+  uint32_t gid = 0;
+  int gid_bytes = 0;
+
+  for (char c : text) {
+    if (c == '=' || c == '<') {
+      break;
+    }
+
+    int8_t sextet = lookup[static_cast<unsigned char>(c)];
+    if (sextet < 0) {
+      continue; // whitespace
+    }
+
+    bits = (bits << 6) | static_cast<uint32_t>(sextet);
+    bit_count += 6;
+
+    if (bit_count >= 8) {
+      bit_count -= 8;
+      uint32_t byte = (bits >> bit_count) & 0xFF;
+
+      gid |= byte << (8 * gid_bytes);
+      if (++gid_bytes == 4) {
+        set_tile(ids, count++, gid);
+        gid = 0;
+        gid_bytes = 0;
+      }
+    }
+  }
+
+  return count;
+}
+
+std::unique_ptr<MapConfig>
+MapSerializer::load_tmx(const std::string &file_path) {
+  std::string content;
+  if (!read_file(file_path, content)) {
+    LoggerManager::log_error("Could not open file " + file_path);
+    return nullptr;
+  }
+
+  XmlReader reader(content);
+  XmlTag tag;
+
+  std::unique_ptr<MapConfig> config = nullptr;
+  Tileset *tileset = nullptr;
+  Layer *layer = nullptr;
+  bool in_data = false;
+  size_t xml_tile_count = 0;
+
+  while (reader.next_tag(tag)) {
+    if (tag.closing) {
+      if (tag.name == "tileset") {
+        tileset = nullptr;
+      } else if (tag.name == "layer") {
+        layer = nullptr;
+      } else if (tag.name == "data") {
+        in_data = false;
+      }
+      continue;
+    }
+
+    if (tag.name == "map") {
+      if (tag.get("orientation") != "orthogonal") {
+        LoggerManager::log_warning("Map " + file_path +
+                                   " is not orthogonal, it may render wrong");
+      }
+      if (tag.get_int("infinite") != 0) {
+        LoggerManager::log_error("Could not load map " + file_path +
+                                 ": infinite maps are not supported");
+        return nullptr;
+      }
+
+      config = std::make_unique<MapConfig>(
+          std::filesystem::path(file_path).stem().string(),
+          tag.get_int("width"), tag.get_int("height"),
+          tag.get_int("tilewidth", DEFAULT_TILE_SIZE));
+      continue;
+    }
+
+    if (config == nullptr) {
+      continue;
+    }
+
+    if (tag.name == "tileset") {
+      if (tag.has("source")) {
+        LoggerManager::log_warning("External tileset " +
+                                   std::string(tag.get("source")) +
+                                   " is not supported, embed it in the map");
+        continue;
+      }
+
+      Tileset new_tileset;
+      new_tileset.name = tag.get("name");
+      new_tileset.first_gid = tag.get_int("firstgid", 1);
+      new_tileset.tile_width = tag.get_int("tilewidth", config->tile_size);
+      new_tileset.tile_height = tag.get_int("tileheight", config->tile_size);
+      new_tileset.tile_count = tag.get_int("tilecount");
+      new_tileset.columns = tag.get_int("columns", 1);
+      config->tilesets.push_back(new_tileset);
+
+      tileset = tag.self_closing ? nullptr : &config->tilesets.back();
+    } else if (tag.name == "image") {
+      if (tileset != nullptr) {
+        tileset->image_source = tag.get("source");
+        tileset->image_width = tag.get_int("width");
+        tileset->image_height = tag.get_int("height");
+      }
+    } else if (tag.name == "layer") {
+      int width = tag.get_int("width", config->width);
+      int height = tag.get_int("height", config->height);
+      std::string name(tag.get("name"));
+
+      config->layers.emplace_back(
+          name, is_obstacle_layer_name(name) ? OBSTACLE_LAYER : TILE_LAYER,
+          nullptr, width, height, config->tile_size,
+          std::vector<uint16_t>(static_cast<size_t>(width) * height));
+
+      layer = &config->layers.back();
+      layer->visible = tag.get_int("visible", 1) != 0;
+
+      if (tag.self_closing) {
+        layer = nullptr;
+      }
+    } else if (tag.name == "property") {
+      if (layer != nullptr &&
+          ((tag.get("name") == "type" && tag.get("value") == "obstacle") ||
+           (tag.get("name") == "obstacle" && tag.get("value") == "true"))) {
+        layer->type = OBSTACLE_LAYER;
+      }
+    } else if (tag.name == "data") {
+      if (layer == nullptr || tag.self_closing) {
+        continue;
+      }
+
+      if (tag.has("compression")) {
+        LoggerManager::log_error("Could not load map " + file_path +
+                                 ": compressed layer data is not supported");
+        return nullptr;
+      }
+
+      std::string_view encoding = tag.get("encoding");
+      size_t expected = layer->ids.size();
+      size_t decoded = expected;
+
+      if (encoding == "csv") {
+        decoded = decode_csv(reader.text_until_tag(), layer->ids);
+      } else if (encoding == "base64") {
+        decoded = decode_base64(reader.text_until_tag(), layer->ids);
+      } else {
+        // plain XML, one <tile gid="..."/> per cell
+        in_data = true;
+        xml_tile_count = 0;
+      }
+
+      if (decoded != expected) {
+        LoggerManager::log_warning(
+            "Layer " + layer->name + " holds " + std::to_string(decoded) +
+            " tiles instead of " + std::to_string(expected));
+      }
+    } else if (tag.name == "tile") {
+      if (in_data && layer != nullptr) {
+        set_tile(layer->ids, xml_tile_count++,
+                 static_cast<uint32_t>(tag.get_int("gid")));
+      }
+    } else if (tag.name == "chunk") {
+      LoggerManager::log_warning("Chunked layer data is not supported");
+    }
+  }
+
+  if (config == nullptr) {
+    LoggerManager::log_error("Could not load map " + file_path +
+                             ": missing <map> element");
+    return nullptr;
+  }
+
+  assign_layer_tilesets(*config);
+
+  return config;
+}
+
+bool MapSerializer::cook(const MapConfig &config,
+                         const std::string &file_path) {
+  CookedMap::Header header = {};
+  std::memcpy(header.magic, CookedMap::MAGIC, sizeof(header.magic));
+  header.version = CookedMap::VERSION;
+  header.width = config.width;
+  header.height = config.height;
+  header.tile_size = config.tile_size;
+  header.tileset_count = config.tilesets.size();
+  header.layer_count = config.layers.size();
+  copy_string(header.name, sizeof(header.name), config.name);
+
+  std::vector<CookedMap::Tileset> tilesets;
+  for (const auto &tileset : config.tilesets) {
+    CookedMap::Tileset record = {};
+    record.first_gid = tileset.first_gid;
+    record.tile_width = tileset.tile_width;
+    record.tile_height = tileset.tile_height;
+    record.tile_count = tileset.tile_count;
+    record.columns = tileset.columns;
+    record.image_width = tileset.image_width;
+    record.image_height = tileset.image_height;
+    copy_string(record.name, sizeof(record.name), tileset.name);
+    copy_string(record.image_source, sizeof(record.image_source),
+                tileset.image_source);
+    tilesets.push_back(record);
+  }
+
+  // the tile ids follow the tables, one aligned block per layer
+  size_t offset = sizeof(CookedMap::Header) +
+                  tilesets.size() * sizeof(CookedMap::Tileset) +
+                  config.layers.size() * sizeof(CookedMap::Layer);
+
+  std::vector<CookedMap::Layer> layers;
+  std::vector<std::vector<uint16_t>> layer_ids;
+  for (const auto &layer : config.layers) {
+    size_t tile_count = layer.get_tile_count();
+
+    std::vector<uint16_t> ids(tile_count);
+    for (size_t i = 0; i < tile_count; i++) {
+      ids[i] = static_cast<uint16_t>(layer.get_tile_id(i));
+    }
+
+    CookedMap::Layer record = {};
+    copy_string(record.name, sizeof(record.name), layer.name);
+    record.type = layer.type;
+    record.visible = layer.visible;
+    record.width = layer.width;
+    record.height = layer.height;
+    record.first_gid = layer.first_gid;
+    record.columns = layer.columns;
+    record.data_offset = offset;
+    layers.push_back(record);
+
+    offset = align(offset + tile_count * sizeof(uint16_t));
+    layer_ids.push_back(std::move(ids));
+  }
+
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    LoggerManager::log_error("Could not open file " + file_path);
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(tilesets.data()),
+             tilesets.size() * sizeof(CookedMap::Tileset));
+  file.write(reinterpret_cast<const char *>(layers.data()),
+             layers.size() * sizeof(CookedMap::Layer));
+
+  const char padding[CookedMap::DATA_ALIGNMENT] = {};
+  for (size_t i = 0; i < layers.size(); i++) {
+    size_t size = layer_ids[i].size() * sizeof(uint16_t);
+    file.write(reinterpret_cast<const char *>(layer_ids[i].data()), size);
+    file.write(padding, align(size) - size);
+  }
+
+  if (!file.good()) {
+    LoggerManager::log_error("Could not write file " + file_path);
+    return false;
+  }
+
+  return true;
+}
+
+std::unique_ptr<MapConfig> MapSerializer::load_cooked(const MappedFile &file) {
+  const auto *header = file.get<CookedMap::Header>(0);
+  if (header == nullptr ||
+      std::memcmp(header->magic, CookedMap::MAGIC, sizeof(header->magic)) !=
+          0 ||
+      header->version != CookedMap::VERSION) {
+    LoggerManager::log_error("Could not load cooked map: invalid header");
+    return nullptr;
+  }
+
+  size_t offset = sizeof(CookedMap::Header);
+  const auto *tilesets =
+      file.get<CookedMap::Tileset>(offset, header->tileset_count);
+  offset += header->tileset_count * sizeof(CookedMap::Tileset);
+  const auto *layers = file.get<CookedMap::Layer>(offset, header->layer_count);
+
+  if ((header->tileset_count > 0 && tilesets == nullptr) ||
+      (header->layer_count > 0 && layers == nullptr)) {
+    LoggerManager::log_error("Could not load cooked map: truncated file");
+    return nullptr;
+  }
+
+  auto config = std::make_unique<MapConfig>(
+      read_string(header->name, sizeof(header->name)), header->width,
+      header->height, header->tile_size);
+
+  for (uint32_t i = 0; i < header->tileset_count; i++) {
+    const CookedMap::Tileset &record = tilesets[i];
+
+    Tileset tileset;
+    tileset.name = read_string(record.name, sizeof(record.name));
+    tileset.first_gid = record.first_gid;
+    tileset.tile_width = record.tile_width;
+    tileset.tile_height = record.tile_height;
+    tileset.tile_count = record.tile_count;
+    tileset.columns = record.columns;
+    tileset.image_source =
+        read_string(record.image_source, sizeof(record.image_source));
+    tileset.image_width = record.image_width;
+    tileset.image_height = record.image_height;
+    config->tilesets.push_back(tileset);
+  }
+
+  config->layers.reserve(header->layer_count);
+  for (uint32_t i = 0; i < header->layer_count; i++) {
+    const CookedMap::Layer &record = layers[i];
+
+    const auto *ids = file.get<uint16_t>(
+        record.data_offset, static_cast<size_t>(record.width) * record.height);
+    if (ids == nullptr) {
+      LoggerManager::log_error("Could not load cooked map: truncated layer " +
+                               read_string(record.name, sizeof(record.name)));
+      return nullptr;
+    }
+
+    config->layers.emplace_back(read_string(record.name, sizeof(record.name)),
+                                static_cast<LayerType>(record.type), nullptr,
+                                record.width, record.height, header->tile_size,
+                                std::vector<uint16_t>());
+
+    Layer &layer = config->layers.back();
+    layer.visible = record.visible != 0;
+    layer.first_gid = record.first_gid;
+    layer.columns = std::max<int>(record.columns, 1);
+    layer.mapped_ids = ids;
+  }
+
+  return config;
+}
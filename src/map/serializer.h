@@ -0,0 +1,47 @@
+#pragma once
+
+#include "map.h"
+#include <core/config.h>
+#include <io/mapped_file.h>
+
+namespace MapSerializer {
+
+/**
+ * Load a Tiled .tmx map in a single pass over the file. No document tree is
+ * built: tilesets and layers are read as their tags are met and the CSV,
+ * base64 or XML layer data is decoded straight into the tile ids of the layers.
+ * Compressed layer data and infinite maps are not supported.
+ * @param file_path The path of the .tmx file.
+ * @return The loaded map, nullptr on error.
+ */
+std::unique_ptr<MapConfig> load_tmx(const std::string &file_path);
+
+/**
+ * Write a map in the cooked binary format (see cooked_map.h), meant to be
+ * done offline so that loading the map is only a matter of mapping the file.
+ * @param config The map to write.
+ * @param file_path The path of the .pzm file to write.
+ * @return true if the file was written.
+ */
+bool cook(const MapConfig &config, const std::string &file_path);
+
+/**
+ * Read a cooked map from a mapped file. The tile ids are not copied, the
+ * layers point into the mapping which must outlive the returned map.
+ * @return The loaded map, nullptr on error.
+ */
+std::unique_ptr<MapConfig> load_cooked(const MappedFile &file);
+
+/**
+ * Decode CSV layer data, stopping at the end of the text or at the first '<'.
+ * @return The number of tiles written.
+ */
+size_t decode_csv(std::string_view text, std::vector<uint16_t> &ids);
+
+/**
+ * Decode uncompressed base64 layer data made of little endian 32 bits gids.
+ * @return The number of tiles written.
+ */
+size_t decode_base64(std::string_view text, std::vector<uint16_t> &ids);
+
+} // namespace MapSerializer
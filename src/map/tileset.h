@@ -0,0 +1,26 @@
+#pragma once
+
+#include <core/config.h>
+#include <managers/asset/asset_manager.h>
+
+struct Tileset {
+  std::string name;
+  int first_gid = 1;
+  int tile_width = DEFAULT_TILE_SIZE;
+  int tile_height = DEFAULT_TILE_SIZE;
+  int tile_count = 0;
+  int columns = 1;
+
+  // image of the tileset, as referenced by the map file
+  std::string image_source;
+  int image_width = 0;
+  int image_height = 0;
+
+  SDL_Texture *texture = nullptr;
+  // the image streaming in, its texture is set once uploaded
+  TextureHandle handle;
+
+  bool contains(int gid) const {
+    return gid >= first_gid && gid < first_gid + tile_count;
+  }
+};
@@ -0,0 +1,108 @@
+#include "flow_field.h"
+
+#include <functional>
+
+namespace {
+
+constexpr float SQRT2 = 1.41421356f;
+
+struct OpenNode {
+  float distance;
+  uint32_t index;
+
+  bool operator>(const OpenNode &other) const {
+    return distance > other.distance;
+  }
+};
+
+} // namespace
+
+void FlowField::build(const NavGrid &grid, Vector2i goal) {
+  _goal = goal;
+  _width = grid.get_width();
+  _height = grid.get_height();
+  _distances.assign(grid.get_size(), UNREACHABLE);
+  _directions.assign(grid.get_size(), NO_DIRECTION);
+
+  if (!grid.is_walkable(goal.x, goal.y)) {
+    return;
+  }
+
+  std::vector<OpenNode> open;
+  open.reserve(grid.get_size());
+
+  uint32_t goal_index = static_cast<uint32_t>(grid.get_index(goal.x, goal.y));
+  _distances[goal_index] = 0.0f;
+  open.push_back({0.0f, goal_index});
+
+  // spread outwards from the goal, every tile reached points back at the
+  // tile it was reached from
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), std::greater<OpenNode>());
+    OpenNode node = open.back();
+    open.pop_back();
+
+    // reached again with a lower distance after being pushed
+    if (node.distance > _distances[node.index]) {
+      continue;
+    }
+
+    int x = static_cast<int>(node.index % _width);
+    int y = static_cast<int>(node.index / _width);
+    // walking into this tile costs its extra cost on top of the distance
+    float enter_cost = static_cast<float>(grid.get_cost(node.index));
+
+    for (uint8_t i = 0; i < 8; i++) {
+      int dx = DIRECTIONS[i][0];
+      int dy = DIRECTIONS[i][1];
+      int neighbor_x = x + dx;
+      int neighbor_y = y + dy;
+
+      // moves are symmetric, the corners checked are the same both ways
+      if (!grid.is_walkable(neighbor_x, neighbor_y) ||
+          (dx != 0 && dy != 0 &&
+           (!grid.is_walkable(neighbor_x, y) ||
+            !grid.is_walkable(x, neighbor_y)))) {
+        continue;
+      }
+
+      float step = (dx != 0 && dy != 0) ? SQRT2 : 1.0f;
+      float distance = node.distance + step + enter_cost;
+
+      uint32_t neighbor =
+          static_cast<uint32_t>(grid.get_index(neighbor_x, neighbor_y));
+      if (distance < _distances[neighbor]) {
+        _distances[neighbor] = distance;
+        // the way back towards the tile it was reached from
+        _directions[neighbor] = i ^ 1;
+        open.push_back({distance, neighbor});
+        std::push_heap(open.begin(), open.end(), std::greater<OpenNode>());
+      }
+    }
+  }
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::get(const NavGrid &grid,
+                                                     Vector2i goal) {
+  if (!grid.is_walkable(goal.x, goal.y)) {
+    return nullptr;
+  }
+
+  for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+    Vector2i entry_goal = (*it)->get_goal();
+    if (entry_goal.x == goal.x && entry_goal.y == goal.y) {
+      _entries.splice(_entries.begin(), _entries, it);
+      return _entries.front();
+    }
+  }
+
+  auto field = std::make_shared<FlowField>();
+  field->build(grid, goal);
+  _build_count++;
+
+  _entries.push_front(field);
+  if (_entries.size() > _capacity) {
+    _entries.pop_back();
+  }
+  return field;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "nav_grid.h"
+
+#include <limits>
+#include <list>
+
+/**
+ * Directions towards a single goal for every tile of a NavGrid, from one
+ * Dijkstra pass started at the goal. Any number of walkers heading to the
+ * same goal read their next step in O(1) instead of searching on their own.
+ *
+ * Moves follow the rules of the Pathfinder: 8 directions, no corner cutting,
+ * entering a tile costs its distance plus the extra cost of the tile.
+ */
+class FlowField {
+public:
+  FlowField() = default;
+
+  void build(const NavGrid &grid, Vector2i goal);
+
+  Vector2i get_goal() const { return _goal; }
+  int get_width() const { return _width; }
+  int get_height() const { return _height; }
+
+  bool in_bounds(int x, int y) const {
+    return x >= 0 && y >= 0 && x < _width && y < _height;
+  }
+
+  // the goal can be reached from the tile
+  bool is_reachable(int x, int y) const {
+    return in_bounds(x, y) &&
+           _distances[static_cast<size_t>(y) * _width + x] != UNREACHABLE;
+  }
+
+  // cost of the walk from the tile to the goal, infinite when unreachable
+  float get_distance(int x, int y) const {
+    return in_bounds(x, y) ? _distances[static_cast<size_t>(y) * _width + x]
+                           : UNREACHABLE;
+  }
+
+  // the step to take from the tile, (0, 0) on the goal or when unreachable
+  Vector2i get_direction(int x, int y) const {
+    if (!in_bounds(x, y)) {
+      return Vector2i(0, 0);
+    }
+
+    uint8_t direction = _directions[static_cast<size_t>(y) * _width + x];
+    if (direction == NO_DIRECTION) {
+      return Vector2i(0, 0);
+    }
+    return Vector2i(DIRECTIONS[direction][0], DIRECTIONS[direction][1]);
+  }
+
+  size_t get_memory_size() const {
+    return _distances.size() * sizeof(float) + _directions.size();
+  }
+
+private:
+  static constexpr uint8_t NO_DIRECTION = UINT8_MAX;
+  static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+  // opposite directions are pairs, flipping the lowest bit reverses one
+  static constexpr int DIRECTIONS[8][2] = {{1, 0},  {-1, 0}, {0, 1},
+                                           {0, -1}, {1, 1},  {-1, -1},
+                                           {1, -1}, {-1, 1}};
+
+  Vector2i _goal = Vector2i(0, 0);
+  int _width = 0;
+  int _height = 0;
+  std::vector<float> _distances;
+  // index into DIRECTIONS, one per tile
+  std::vector<uint8_t> _directions;
+};
+
+/**
+ * Flow fields kept per goal tile, the least recently used ones are dropped
+ * past the capacity. The fields are built against the grid given to get()
+ * and must be invalidated when the walkability or the costs of that grid
+ * change.
+ *
+ * Fields are shared, a walker holding one keeps it alive after it is
+ * evicted or invalidated and only sees the change once it asks again.
+ */
+class FlowFieldCache {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 16;
+
+  explicit FlowFieldCache(size_t capacity = DEFAULT_CAPACITY)
+      : _capacity(std::max<size_t>(capacity, 1)) {}
+
+  // the field towards `goal`, built on first use, null if the goal is blocked
+  std::shared_ptr<const FlowField> get(const NavGrid &grid, Vector2i goal);
+
+  void invalidate() { _entries.clear(); }
+
+  void set_capacity(size_t capacity) {
+    _capacity = std::max<size_t>(capacity, 1);
+    while (_entries.size() > _capacity) {
+      _entries.pop_back();
+    }
+  }
+
+  size_t get_size() const { return _entries.size(); }
+  size_t get_build_count() const { return _build_count; }
+
+private:
+  // most recently used first, a linear scan beats a map for a few goals
+  std::list<std::shared_ptr<const FlowField>> _entries;
+  size_t _capacity;
+  size_t _build_count = 0;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <map/layer.h>
+
+/**
+ * Walkability of the map tiles, built from its obstacle layers. A tile is
+ * blocked when a tile of any obstacle layer is a wall. Costs come from the
+ * cost plane of the layers and are only stored when one is set, a grid
+ * without them is uniform and can be searched with jump points.
+ */
+class NavGrid {
+public:
+  NavGrid() = default;
+  NavGrid(int width, int height)
+      : _width(width), _height(height),
+        _walkable(static_cast<size_t>(width) * height, 1) {}
+
+  // rebuild the grid from the layers of a map
+  void build(const std::vector<Layer> &layers, int width, int height) {
+    _width = width;
+    _height = height;
+    _walkable.assign(static_cast<size_t>(width) * height, 1);
+    _costs.clear();
+    _costly_count = 0;
+
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        update(layers, x, y);
+      }
+    }
+  }
+
+  // refresh a single tile after a layer changed, true if it changed
+  bool update(const std::vector<Layer> &layers, int x, int y) {
+    if (!in_bounds(x, y)) {
+      return false;
+    }
+
+    bool walkable = true;
+    int cost = 0;
+    for (const auto &layer : layers) {
+      if (x >= layer.width || y >= layer.height) {
+        continue;
+      }
+
+      size_t index = layer.get_index(x, y);
+      if (layer.type == OBSTACLE_LAYER &&
+          layer.get_tile_type(index) == TileType::WALL) {
+        walkable = false;
+      }
+      cost += layer.get_tile_cost(index);
+    }
+
+    size_t index = get_index(x, y);
+    bool was_walkable = _walkable[index] != 0;
+    int previous_cost = get_cost(index);
+
+    set_walkable(x, y, walkable);
+    set_cost(x, y, static_cast<uint16_t>(std::min(cost, UINT16_MAX)));
+    return walkable != was_walkable || get_cost(index) != previous_cost;
+  }
+
+  int get_width() const { return _width; }
+  int get_height() const { return _height; }
+  size_t get_size() const { return _walkable.size(); }
+
+  bool in_bounds(int x, int y) const {
+    return x >= 0 && y >= 0 && x < _width && y < _height;
+  }
+  size_t get_index(int x, int y) const {
+    return static_cast<size_t>(y) * _width + x;
+  }
+
+  bool is_walkable(int x, int y) const {
+    return in_bounds(x, y) && _walkable[get_index(x, y)] != 0;
+  }
+  void set_walkable(int x, int y, bool walkable) {
+    _walkable[get_index(x, y)] = walkable ? 1 : 0;
+  }
+
+  // extra cost of entering a tile, on top of the distance
+  int get_cost(size_t index) const {
+    return _costs.empty() ? 0 : _costs[index];
+  }
+  void set_cost(int x, int y, uint16_t cost) {
+    if (_costs.empty()) {
+      if (cost == 0) {
+        return;
+      }
+      _costs.resize(_walkable.size());
+    }
+
+    uint16_t &current = _costs[get_index(x, y)];
+    _costly_count += (cost != 0) - (current != 0);
+    current = cost;
+  }
+
+  // every walkable tile costs the same, jump point search applies
+  bool is_uniform() const { return _costly_count == 0; }
+
+private:
+  int _width = 0;
+  int _height = 0;
+  std::vector<uint8_t> _walkable;
+  std::vector<uint16_t> _costs;
+  // tiles with an extra cost
+  size_t _costly_count = 0;
+};
@@ -0,0 +1,160 @@
+#include "path_queue.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+void PathQueue::start(size_t worker_count) {
+  stop();
+
+#if HAS_THREADS
+  if (worker_count == 0) {
+    worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  }
+
+  _is_stopping = false;
+  for (size_t i = 0; i < worker_count; i++) {
+    _workers.emplace_back(&PathQueue::run_worker, this);
+  }
+#endif
+}
+
+void PathQueue::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_stopping = true;
+    _batches.clear();
+    _results.clear();
+  }
+  _condition.notify_all();
+
+  for (auto &worker : _workers) {
+    worker.join();
+  }
+  _workers.clear();
+
+  _pending.clear();
+  _in_flight.clear();
+}
+
+PathRequestId PathQueue::submit(Vector2i start, Vector2i goal,
+                                PathCallback callback, PathMode mode) {
+  PathRequestId id = _next_id++;
+  if (_next_id == 0) {
+    _next_id = 1;
+  }
+
+  _pending.push_back({id, start, goal, mode});
+  _in_flight.emplace(id, std::move(callback));
+  return id;
+}
+
+void PathQueue::cancel(PathRequestId id) {
+  // the query may already be on a worker, its result is dropped in collect()
+  _in_flight.erase(id);
+}
+
+void PathQueue::dispatch() {
+  if (_grid == nullptr) {
+    return;
+  }
+
+  size_t budget = _frame_budget;
+  while (!_pending.empty() && budget > 0) {
+    Batch batch;
+    batch.grid = _grid;
+
+    while (!_pending.empty() && budget > 0 &&
+           batch.requests.size() < _batch_size) {
+      Request request = _pending.front();
+      _pending.pop_front();
+
+      // cancelled before leaving the queue
+      if (_in_flight.count(request.id) == 0) {
+        continue;
+      }
+      batch.requests.push_back(request);
+      budget--;
+    }
+
+    if (batch.requests.empty()) {
+      continue;
+    }
+
+    if (_workers.empty()) {
+      std::vector<PathResult> results;
+      process(_pathfinder, batch, results);
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::move(results.begin(), results.end(), std::back_inserter(_results));
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _batches.push_back(std::move(batch));
+    }
+    _condition.notify_one();
+  }
+}
+
+void PathQueue::collect() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _collected.swap(_results);
+  }
+
+  for (const auto &result : _collected) {
+    auto it = _in_flight.find(result.id);
+    if (it == _in_flight.end()) {
+      continue; // cancelled
+    }
+
+    PathCallback callback = std::move(it->second);
+    _in_flight.erase(it);
+    if (callback) {
+      callback(result);
+    }
+  }
+  _collected.clear();
+}
+
+void PathQueue::run_worker() {
+  Pathfinder pathfinder;
+  std::vector<PathResult> results;
+
+  while (true) {
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock,
+                      [this] { return _is_stopping || !_batches.empty(); });
+      if (_is_stopping) {
+        return;
+      }
+
+      batch = std::move(_batches.front());
+      _batches.pop_front();
+    }
+
+    process(pathfinder, batch, results);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::move(results.begin(), results.end(), std::back_inserter(_results));
+    results.clear();
+  }
+}
+
+void PathQueue::process(Pathfinder &pathfinder, const Batch &batch,
+                        std::vector<PathResult> &results) {
+  for (const auto &request : batch.requests) {
+    PathResult result;
+    result.id = request.id;
+    result.found = pathfinder.find_path(*batch.grid, request.start,
+                                        request.goal, result.path,
+                                        request.mode);
+    results.push_back(std::move(result));
+  }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "pathfinder.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using PathRequestId = uint32_t;
+
+struct PathResult {
+  PathRequestId id = 0;
+  bool found = false;
+  std::vector<Vector2i> path;
+};
+
+using PathCallback = std::function<void(const PathResult &)>;
+
+/**
+ * Path queries answered on worker threads. Queries are submitted from the
+ * simulation thread and sent to the workers in batches, a limited number per
+ * frame, against an immutable snapshot of the navigation grid. Their
+ * callbacks run on the simulation thread, in collect(), one frame or more
+ * after submission.
+ *
+ * The simulation thread is the one running the frame function: the
+ * FramePipeline producer, or the main thread when the pipeline is not
+ * threaded. Everything but the workers must be used from that thread only.
+ *
+ * Builds without threads (wasm without pthreads) answer the dispatched
+ * queries right away in dispatch().
+ */
+class PathQueue {
+public:
+  // queries handed to a worker at once
+  static constexpr size_t DEFAULT_BATCH_SIZE = 16;
+  // queries dispatched per frame
+  static constexpr size_t DEFAULT_FRAME_BUDGET = 256;
+
+  PathQueue() = default;
+  ~PathQueue() { stop(); }
+
+  PathQueue(const PathQueue &) = delete;
+  PathQueue &operator=(const PathQueue &) = delete;
+
+  // start the workers, 0 picks one less than the number of cores
+  void start(size_t worker_count = 0);
+  // wait for the workers, pending queries are dropped without a callback
+  void stop();
+
+  // the grid used by the next dispatched queries
+  void set_grid(std::shared_ptr<const NavGrid> grid) { _grid = std::move(grid); }
+  void set_batch_size(size_t size) { _batch_size = std::max<size_t>(size, 1); }
+  void set_frame_budget(size_t budget) { _frame_budget = budget; }
+
+  PathRequestId submit(Vector2i start, Vector2i goal, PathCallback callback,
+                       PathMode mode = PathMode::AUTO);
+  // the callback of a query is not called once it is cancelled
+  void cancel(PathRequestId id);
+
+  // send up to the frame budget of pending queries to the workers
+  void dispatch();
+  // run the callbacks of the answered queries
+  void collect();
+
+  // called once per frame, on the simulation thread
+  void update() {
+    dispatch();
+    collect();
+  }
+
+  size_t get_pending_count() const { return _pending.size(); }
+  size_t get_in_flight_count() const { return _in_flight.size(); }
+
+private:
+  struct Request {
+    PathRequestId id;
+    Vector2i start;
+    Vector2i goal;
+    PathMode mode;
+  };
+
+  struct Batch {
+    std::shared_ptr<const NavGrid> grid;
+    std::vector<Request> requests;
+  };
+
+  void run_worker();
+  static void process(Pathfinder &pathfinder, const Batch &batch,
+                      std::vector<PathResult> &results);
+
+  // simulation thread only
+  std::shared_ptr<const NavGrid> _grid;
+  std::deque<Request> _pending;
+  std::unordered_map<PathRequestId, PathCallback> _in_flight;
+  PathRequestId _next_id = 1;
+  size_t _batch_size = DEFAULT_BATCH_SIZE;
+  size_t _frame_budget = DEFAULT_FRAME_BUDGET;
+  std::vector<PathResult> _collected;
+
+  // shared with the workers
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::deque<Batch> _batches;
+  std::vector<PathResult> _results;
+  bool _is_stopping = false;
+
+  std::vector<std::thread> _workers;
+  // answers the queries when there is no worker
+  Pathfinder _pathfinder;
+};
@@ -0,0 +1,297 @@
+#include "pathfinder.h"
+
+#include <functional>
+#include <limits>
+
+namespace {
+
+constexpr float SQRT2 = 1.41421356f;
+
+constexpr int DIRECTIONS[8][2] = {{1, 0},  {-1, 0}, {0, 1},  {0, -1},
+                                  {1, 1},  {1, -1}, {-1, 1}, {-1, -1}};
+
+int sign(int value) { return (value > 0) - (value < 0); }
+
+float octile(int dx, int dy) {
+  dx = std::abs(dx);
+  dy = std::abs(dy);
+  return static_cast<float>(std::max(dx, dy) - std::min(dx, dy)) +
+         SQRT2 * static_cast<float>(std::min(dx, dy));
+}
+
+// diagonal moves need both side tiles to be free, paths never cut corners
+bool can_move(const NavGrid &grid, int x, int y, int dx, int dy) {
+  if (!grid.is_walkable(x + dx, y + dy)) {
+    return false;
+  }
+  return dx == 0 || dy == 0 ||
+         (grid.is_walkable(x + dx, y) && grid.is_walkable(x, y + dy));
+}
+
+} // namespace
+
+void Pathfinder::reserve(size_t cell_count) {
+  if (_g.size() >= cell_count) {
+    return;
+  }
+
+  _g.resize(cell_count);
+  _parents.resize(cell_count);
+  _stamps.resize(cell_count, 0);
+  _closed.resize(cell_count);
+  _open.reserve(cell_count);
+}
+
+bool Pathfinder::find_path(const NavGrid &grid, Vector2i start, Vector2i goal,
+                           std::vector<Vector2i> &path, PathMode mode) {
+  path.clear();
+  _expanded_count = 0;
+
+  if (!grid.is_walkable(start.x, start.y) ||
+      !grid.is_walkable(goal.x, goal.y)) {
+    return false;
+  }
+  if (start.x == goal.x && start.y == goal.y) {
+    return true;
+  }
+
+  bool use_jump_points = mode == PathMode::JPS ||
+                         (mode == PathMode::AUTO && grid.is_uniform());
+
+  begin_query(grid.get_size());
+  _goal_x = goal.x;
+  _goal_y = goal.y;
+
+  uint32_t goal_index = static_cast<uint32_t>(grid.get_index(goal.x, goal.y));
+  open(static_cast<uint32_t>(grid.get_index(start.x, start.y)), NO_PARENT, 0.0f,
+       heuristic(start.x, start.y));
+
+  uint32_t index;
+  while (pop(index)) {
+    if (index == goal_index) {
+      build_path(grid, goal_index, path);
+      return true;
+    }
+
+    _expanded_count++;
+    if (use_jump_points) {
+      expand_jump_points(grid, index);
+    } else {
+      expand_neighbors(grid, index);
+    }
+  }
+
+  return false;
+}
+
+void Pathfinder::begin_query(size_t cell_count) {
+  reserve(cell_count);
+  _open.clear();
+
+  // the stamps wrapped around, old ones could be mistaken for this query
+  if (++_stamp == 0) {
+    std::fill(_stamps.begin(), _stamps.end(), 0);
+    _stamp = 1;
+  }
+}
+
+float Pathfinder::get_g(uint32_t index) const {
+  return _stamps[index] == _stamp ? _g[index]
+                                  : std::numeric_limits<float>::infinity();
+}
+
+void Pathfinder::open(uint32_t index, uint32_t parent, float g, float h) {
+  if (_stamps[index] != _stamp) {
+    _stamps[index] = _stamp;
+    _closed[index] = 0;
+  }
+
+  _g[index] = g;
+  _parents[index] = parent;
+
+  // a tile reached again with a lower cost is pushed again, the stale entry
+  // is skipped once popped
+  _open.push_back({g + h, index});
+  std::push_heap(_open.begin(), _open.end(), std::greater<OpenNode>());
+}
+
+bool Pathfinder::pop(uint32_t &index) {
+  while (!_open.empty()) {
+    std::pop_heap(_open.begin(), _open.end(), std::greater<OpenNode>());
+    index = _open.back().index;
+    _open.pop_back();
+
+    if (!_closed[index]) {
+      _closed[index] = 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Pathfinder::expand_neighbors(const NavGrid &grid, uint32_t index) {
+  int x = static_cast<int>(index % grid.get_width());
+  int y = static_cast<int>(index / grid.get_width());
+  float g = _g[index];
+
+  for (const auto &direction : DIRECTIONS) {
+    int dx = direction[0];
+    int dy = direction[1];
+    if (!can_move(grid, x, y, dx, dy)) {
+      continue;
+    }
+
+    uint32_t neighbor =
+        static_cast<uint32_t>(grid.get_index(x + dx, y + dy));
+    if (_stamps[neighbor] == _stamp && _closed[neighbor]) {
+      continue;
+    }
+
+    float step = (dx != 0 && dy != 0) ? SQRT2 : 1.0f;
+    float neighbor_g = g + step + static_cast<float>(grid.get_cost(neighbor));
+    if (neighbor_g < get_g(neighbor)) {
+      open(neighbor, index, neighbor_g, heuristic(x + dx, y + dy));
+    }
+  }
+}
+
+void Pathfinder::expand_jump_points(const NavGrid &grid, uint32_t index) {
+  int x = static_cast<int>(index % grid.get_width());
+  int y = static_cast<int>(index / grid.get_width());
+
+  // the directions worth following, pruned by the way the tile was entered
+  int directions[8][2];
+  int direction_count = 0;
+  auto add = [&](int dx, int dy) {
+    directions[direction_count][0] = dx;
+    directions[direction_count][1] = dy;
+    direction_count++;
+  };
+
+  uint32_t parent = _parents[index];
+  if (parent == NO_PARENT) {
+    for (const auto &direction : DIRECTIONS) {
+      add(direction[0], direction[1]);
+    }
+  } else {
+    int dx = sign(x - static_cast<int>(parent % grid.get_width()));
+    int dy = sign(y - static_cast<int>(parent / grid.get_width()));
+
+    if (dx != 0 && dy != 0) {
+      add(0, dy);
+      add(dx, 0);
+      add(dx, dy);
+    } else if (dx != 0) {
+      add(dx, 0);
+      // a wall behind a side tile forces a turn around it
+      if (grid.is_walkable(x, y + 1) && !grid.is_walkable(x - dx, y + 1)) {
+        add(0, 1);
+        add(dx, 1);
+      }
+      if (grid.is_walkable(x, y - 1) && !grid.is_walkable(x - dx, y - 1)) {
+        add(0, -1);
+        add(dx, -1);
+      }
+    } else {
+      add(0, dy);
+      if (grid.is_walkable(x + 1, y) && !grid.is_walkable(x + 1, y - dy)) {
+        add(1, 0);
+        add(1, dy);
+      }
+      if (grid.is_walkable(x - 1, y) && !grid.is_walkable(x - 1, y - dy)) {
+        add(-1, 0);
+        add(-1, dy);
+      }
+    }
+  }
+
+  float g = _g[index];
+  for (int i = 0; i < direction_count; i++) {
+    int jump_x;
+    int jump_y;
+    if (!jump(grid, x, y, directions[i][0], directions[i][1], jump_x,
+              jump_y)) {
+      continue;
+    }
+
+    uint32_t jump_index = static_cast<uint32_t>(grid.get_index(jump_x, jump_y));
+    if (_stamps[jump_index] == _stamp && _closed[jump_index]) {
+      continue;
+    }
+
+    float jump_g = g + octile(jump_x - x, jump_y - y);
+    if (jump_g < get_g(jump_index)) {
+      open(jump_index, index, jump_g, heuristic(jump_x, jump_y));
+    }
+  }
+}
+
+bool Pathfinder::jump(const NavGrid &grid, int x, int y, int dx, int dy,
+                      int &jump_x, int &jump_y) const {
+  while (can_move(grid, x, y, dx, dy)) {
+    x += dx;
+    y += dy;
+
+    if (x == _goal_x && y == _goal_y) {
+      jump_x = x;
+      jump_y = y;
+      return true;
+    }
+
+    if (dx != 0 && dy != 0) {
+      // a diagonal stops where one of its straight scans finds something
+      int unused_x;
+      int unused_y;
+      if (jump(grid, x, y, dx, 0, unused_x, unused_y) ||
+          jump(grid, x, y, 0, dy, unused_x, unused_y)) {
+        jump_x = x;
+        jump_y = y;
+        return true;
+      }
+    } else if (dx != 0) {
+      if ((grid.is_walkable(x, y + 1) && !grid.is_walkable(x - dx, y + 1)) ||
+          (grid.is_walkable(x, y - 1) && !grid.is_walkable(x - dx, y - 1))) {
+        jump_x = x;
+        jump_y = y;
+        return true;
+      }
+    } else {
+      if ((grid.is_walkable(x + 1, y) && !grid.is_walkable(x + 1, y - dy)) ||
+          (grid.is_walkable(x - 1, y) && !grid.is_walkable(x - 1, y - dy))) {
+        jump_x = x;
+        jump_y = y;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+float Pathfinder::heuristic(int x, int y) const {
+  return octile(_goal_x - x, _goal_y - y);
+}
+
+void Pathfinder::build_path(const NavGrid &grid, uint32_t goal,
+                            std::vector<Vector2i> &path) {
+  int width = grid.get_width();
+
+  // walk back from the goal, filling the straight runs between jump points
+  for (uint32_t index = goal; _parents[index] != NO_PARENT;
+       index = _parents[index]) {
+    int x = static_cast<int>(index % width);
+    int y = static_cast<int>(index / width);
+    int parent_x = static_cast<int>(_parents[index] % width);
+    int parent_y = static_cast<int>(_parents[index] / width);
+    int dx = sign(parent_x - x);
+    int dy = sign(parent_y - y);
+
+    while (x != parent_x || y != parent_y) {
+      path.emplace_back(x, y);
+      x += dx;
+      y += dy;
+    }
+  }
+
+  std::reverse(path.begin(), path.end());
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "nav_grid.h"
+
+enum class PathMode { AUTO, ASTAR, JPS };
+
+/**
+ * A* search over a NavGrid, moving in 8 directions without cutting corners.
+ * On uniform grids the search can use jump point search, which only expands
+ * the tiles where the path may turn.
+ *
+ * The search buffers are sized to the grid once and reused, a query does not
+ * allocate memory. A Pathfinder is not thread safe, use one per thread.
+ */
+class Pathfinder {
+public:
+  Pathfinder() = default;
+  ~Pathfinder() = default;
+
+  // size the buffers for grids of up to `cell_count` tiles
+  void reserve(size_t cell_count);
+
+  /**
+   * Find a path between two tiles.
+   * @param path Filled with the tiles to walk through, the start excluded
+   * and the goal included. Its capacity is kept between queries.
+   * @param mode AUTO uses jump point search on uniform grids.
+   * @return true if the goal can be reached.
+   */
+  bool find_path(const NavGrid &grid, Vector2i start, Vector2i goal,
+                 std::vector<Vector2i> &path, PathMode mode = PathMode::AUTO);
+
+  // tiles expanded by the last query
+  size_t get_expanded_count() const { return _expanded_count; }
+
+private:
+  struct OpenNode {
+    float f;
+    uint32_t index;
+
+    bool operator>(const OpenNode &other) const { return f > other.f; }
+  };
+
+  static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+  void begin_query(size_t cell_count);
+  // g of a tile seen during this query, infinite otherwise
+  float get_g(uint32_t index) const;
+  void open(uint32_t index, uint32_t parent, float g, float h);
+  bool pop(uint32_t &index);
+
+  void expand_neighbors(const NavGrid &grid, uint32_t index);
+  void expand_jump_points(const NavGrid &grid, uint32_t index);
+  // the next jump point from (x, y) in the direction (dx, dy), if any
+  bool jump(const NavGrid &grid, int x, int y, int dx, int dy, int &jump_x,
+            int &jump_y) const;
+
+  float heuristic(int x, int y) const;
+  void build_path(const NavGrid &grid, uint32_t goal,
+                  std::vector<Vector2i> &path);
+
+  std::vector<float> _g;
+  std::vector<uint32_t> _parents;
+  // the query a tile was last seen in, saves clearing the buffers
+  std::vector<uint32_t> _stamps;
+  std::vector<uint8_t> _closed;
+  std::vector<OpenNode> _open;
+
+  uint32_t _stamp = 0;
+  int _goal_x = 0;
+  int _goal_y = 0;
+  size_t _expanded_count = 0;
+};
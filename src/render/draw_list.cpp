@@ -0,0 +1,147 @@
+#include "draw_list.h"
+#include <utils/render_utils.h>
+
+void DrawList::reset() {
+  _commands.clear();
+  _text.clear();
+  _callbacks.clear();
+}
+
+void DrawList::clear(const SDL_Color &color) {
+  DrawCommand command;
+  command.type = DrawCommandType::CLEAR;
+  command.color = color;
+  _commands.push_back(command);
+}
+
+void DrawList::copy(SDL_Texture *texture, const SDL_Rect *src_rect,
+                    const SDL_Rect &dst_rect) {
+  DrawCommand command;
+  command.type = DrawCommandType::COPY;
+  command.texture = texture;
+  // an empty source copies the whole texture
+  if (src_rect != nullptr) {
+    command.src = *src_rect;
+  }
+  command.dst = dst_rect;
+  _commands.push_back(command);
+}
+
+void DrawList::sprite(SDL_Texture *texture, const SDL_Rect &src_rect,
+                      const SDL_Rect &dst_rect, bool flipped) {
+  DrawCommand command;
+  command.type = DrawCommandType::SPRITE;
+  command.flag = flipped;
+  command.texture = texture;
+  command.src = src_rect;
+  command.dst = dst_rect;
+  _commands.push_back(command);
+}
+
+void DrawList::rect(const SDL_Rect &rect, const SDL_Color &color, bool fill) {
+  DrawCommand command;
+  command.type = DrawCommandType::RECT;
+  command.flag = fill;
+  command.color = color;
+  command.dst = rect;
+  _commands.push_back(command);
+}
+
+void DrawList::grid(int width, int height, int tile_size,
+                    const SDL_Color &color) {
+  DrawCommand command;
+  command.type = DrawCommandType::GRID;
+  command.color = color;
+  command.dst = {0, 0, width, height};
+  command.src = {0, 0, tile_size, tile_size};
+  _commands.push_back(command);
+}
+
+void DrawList::text(TTF_Font *font, const std::string &text,
+                    const SDL_Color &color, int x, int y, bool wrap) {
+  DrawCommand command;
+  command.type = DrawCommandType::TEXT;
+  command.flag = wrap;
+  command.color = color;
+  command.font = font;
+  command.dst = {x, y, 0, 0};
+  command.offset = static_cast<uint32_t>(_text.size());
+  command.length = static_cast<uint32_t>(text.size());
+
+  // null terminated for SDL_ttf
+  _text.insert(_text.end(), text.begin(), text.end());
+  _text.push_back('\0');
+  _commands.push_back(command);
+}
+
+void DrawList::callback(Callback callback) {
+  DrawCommand command;
+  command.type = DrawCommandType::CUSTOM;
+  command.offset = static_cast<uint32_t>(_callbacks.size());
+  _callbacks.push_back(std::move(callback));
+  _commands.push_back(command);
+}
+
+DrawStats DrawList::submit(SDL_Renderer *renderer, SpriteBatch &batch) const {
+  DrawStats stats;
+  stats.command_count = _commands.size();
+
+  bool is_batching = false;
+  auto end_batch = [&]() {
+    if (is_batching) {
+      batch.end();
+      stats.sprite_count += batch.get_sprite_count();
+      stats.draw_call_count += batch.get_draw_call_count();
+      is_batching = false;
+    }
+  };
+
+  for (const DrawCommand &command : _commands) {
+    if (command.type == DrawCommandType::SPRITE) {
+      if (!is_batching) {
+        batch.begin(renderer);
+        is_batching = true;
+      }
+      batch.draw(command.texture, command.src, command.dst, command.flag);
+      continue;
+    }
+
+    end_batch();
+    stats.draw_call_count++;
+
+    switch (command.type) {
+    case DrawCommandType::CLEAR:
+      SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g,
+                             command.color.b, command.color.a);
+      SDL_RenderClear(renderer);
+      break;
+    case DrawCommandType::COPY: {
+      bool whole = command.src.w == 0 || command.src.h == 0;
+      SDL_RenderCopy(renderer, command.texture, whole ? nullptr : &command.src,
+                     &command.dst);
+      break;
+    }
+    case DrawCommandType::RECT:
+      RenderUtils::render_rect(renderer, command.dst, command.color,
+                               command.flag);
+      break;
+    case DrawCommandType::GRID:
+      RenderUtils::render_grid(renderer, command.dst.w, command.dst.h,
+                               command.src.w, command.color);
+      break;
+    case DrawCommandType::TEXT:
+      RenderUtils::render_text(renderer, command.font,
+                               _text.data() + command.offset, command.color,
+                               command.dst.x, command.dst.y, command.flag);
+      break;
+    case DrawCommandType::CUSTOM:
+      _callbacks[command.offset](renderer);
+      break;
+    default:
+      break;
+    }
+  }
+
+  end_batch();
+  return stats;
+}
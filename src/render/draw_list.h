@@ -0,0 +1,88 @@
+#pragma once
+
+#include <core/config.h>
+#include <sprite/sprite_batch.h>
+
+#include <functional>
+
+enum class DrawCommandType : uint8_t {
+  CLEAR,
+  COPY,
+  SPRITE,
+  RECT,
+  GRID,
+  TEXT,
+  CUSTOM,
+};
+
+/**
+ * A single draw, only the fields used by its type are meaningful. Text is
+ * kept in the character buffer of the list and callbacks in its callback
+ * list, a command only holds their position there.
+ */
+struct DrawCommand {
+  DrawCommandType type;
+  // COPY and SPRITE mirror the source horizontally, RECT fills the rect,
+  // TEXT wraps its lines
+  bool flag = false;
+  SDL_Color color = {255, 255, 255, 255};
+  SDL_Texture *texture = nullptr;
+  TTF_Font *font = nullptr;
+  SDL_Rect src = {0, 0, 0, 0};
+  SDL_Rect dst = {0, 0, 0, 0};
+  // TEXT characters or CUSTOM callback index
+  uint32_t offset = 0;
+  uint32_t length = 0;
+};
+
+struct DrawStats {
+  size_t command_count = 0;
+  size_t sprite_count = 0;
+  size_t draw_call_count = 0;
+};
+
+/**
+ * Draws recorded by the simulation and replayed later against the renderer,
+ * possibly from another thread. Recording does not touch SDL, every texture
+ * or font referenced must stay alive until the list is replayed.
+ *
+ * The buffers keep their capacity between frames, recording a frame of the
+ * same size as the previous one does not allocate.
+ */
+class DrawList {
+public:
+  // run on the thread replaying the list, for the draws that need the
+  // renderer itself, e.g. baking render targets
+  using Callback = std::function<void(SDL_Renderer *renderer)>;
+
+  DrawList() = default;
+  ~DrawList() = default;
+
+  void reset();
+
+  void clear(const SDL_Color &color);
+  void copy(SDL_Texture *texture, const SDL_Rect *src_rect,
+            const SDL_Rect &dst_rect);
+  // consecutive sprites are drawn through a SpriteBatch
+  void sprite(SDL_Texture *texture, const SDL_Rect &src_rect,
+              const SDL_Rect &dst_rect, bool flipped = false);
+  void rect(const SDL_Rect &rect, const SDL_Color &color, bool fill = true);
+  void grid(int width, int height, int tile_size, const SDL_Color &color);
+  void text(TTF_Font *font, const std::string &text, const SDL_Color &color,
+            int x, int y, bool wrap = false);
+  void callback(Callback callback);
+
+  /**
+   * Replay the commands, in the order they were recorded.
+   * @param batch Reused between replays for its buffers.
+   */
+  DrawStats submit(SDL_Renderer *renderer, SpriteBatch &batch) const;
+
+  size_t size() const { return _commands.size(); }
+  bool empty() const { return _commands.empty(); }
+
+private:
+  std::vector<DrawCommand> _commands;
+  std::vector<char> _text;
+  std::vector<Callback> _callbacks;
+};
@@ -0,0 +1,94 @@
+#include "frame_pipeline.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_THREADS 0
+#else
+#define HAS_THREADS 1
+#endif
+
+void FramePipeline::start(FrameFunction frame, bool threaded) {
+  stop();
+
+  _frame = std::move(frame);
+  _front = 0;
+  _draw_lists[0].reset();
+  _draw_lists[1].reset();
+  _stats = DrawStats();
+
+#if HAS_THREADS
+  if (threaded) {
+    _is_stopping = false;
+    _is_recording = false;
+    _producer = std::thread(&FramePipeline::run_producer, this);
+  }
+#endif
+}
+
+void FramePipeline::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_stopping = true;
+  }
+  _condition.notify_all();
+
+  if (_producer.joinable()) {
+    _producer.join();
+  }
+}
+
+void FramePipeline::run_frame(SDL_Renderer *renderer) {
+  DrawList &back = _draw_lists[1 - _front];
+  DrawList &front = _draw_lists[_front];
+
+  if (!is_threaded()) {
+    back.reset();
+    _frame(back);
+    _stats = back.submit(renderer, _batch);
+    SDL_RenderPresent(renderer);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_recording = true;
+  }
+  _condition.notify_all();
+
+  // the first frame has nothing recorded yet
+  DrawStats stats;
+  if (!front.empty()) {
+    stats = front.submit(renderer, _batch);
+    SDL_RenderPresent(renderer);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [this] { return !_is_recording; });
+  }
+
+  // the producer is idle, the stats can be handed over
+  _stats = stats;
+  _front = 1 - _front;
+}
+
+void FramePipeline::run_producer() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] { return _is_stopping || _is_recording; });
+      if (_is_stopping) {
+        return;
+      }
+    }
+
+    DrawList &back = _draw_lists[1 - _front];
+    back.reset();
+    _frame(back);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _is_recording = false;
+    }
+    _condition.notify_all();
+  }
+}
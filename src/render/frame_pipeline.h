@@ -0,0 +1,61 @@
+#pragma once
+
+#include "draw_list.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * Overlaps the simulation of a frame with the submission of the previous one.
+ * A producer thread runs the frame function, which updates the simulation and
+ * records its draws into one of two draw lists, while the calling thread
+ * replays the other list to the renderer. The lists are swapped once both
+ * halves are done.
+ *
+ * The renderer is only used from the thread calling run_frame(), the one
+ * owning the window. Frames are shown one frame after being simulated.
+ *
+ * Without a producer (not started threaded, or wasm without pthreads) the
+ * frame is recorded and replayed in turn on the calling thread.
+ */
+class FramePipeline {
+public:
+  using FrameFunction = std::function<void(DrawList &draw_list)>;
+
+  FramePipeline() = default;
+  ~FramePipeline() { stop(); }
+
+  FramePipeline(const FramePipeline &) = delete;
+  FramePipeline &operator=(const FramePipeline &) = delete;
+
+  void start(FrameFunction frame, bool threaded = true);
+  // wait for the frame being recorded, the producer is joined
+  void stop();
+
+  // record the next frame and replay the last recorded one, then present
+  void run_frame(SDL_Renderer *renderer);
+
+  bool is_threaded() const { return _producer.joinable(); }
+
+  // replay statistics of the last presented frame, safe to read while
+  // recording
+  const DrawStats &get_stats() const { return _stats; }
+
+private:
+  void run_producer();
+
+  FrameFunction _frame;
+  DrawList _draw_lists[2];
+  // the list replayed next, the other one is being recorded
+  int _front = 0;
+
+  SpriteBatch _batch;
+  DrawStats _stats;
+
+  std::thread _producer;
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _is_recording = false;
+  bool _is_stopping = false;
+};
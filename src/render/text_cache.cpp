@@ -0,0 +1,257 @@
+#include "text_cache.h"
+#include <managers/logger/logger_manager.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// width of the glyph atlas, glyphs are packed in rows
+constexpr int ATLAS_WIDTH = 512;
+
+bool same_color(const SDL_Color &a, const SDL_Color &b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+} // namespace
+
+void TextCache::clean() {
+  for (auto &[font, atlas] : _atlases) {
+    if (atlas.texture != nullptr) {
+      SDL_DestroyTexture(atlas.texture);
+    }
+  }
+  for (auto &entry : _entries) {
+    if (entry.texture != nullptr) {
+      SDL_DestroyTexture(entry.texture);
+    }
+  }
+
+  _atlases.clear();
+  _entries.clear();
+}
+
+size_t TextCache::get_texture_count() const {
+  size_t count = 0;
+  for (const auto &entry : _entries) {
+    count += entry.texture != nullptr;
+  }
+  return count;
+}
+
+void TextCache::render(SDL_Renderer *renderer, TTF_Font *font,
+                       const char *text, SDL_Color color, int x, int y,
+                       int wrap_width) {
+  if (text == nullptr || text[0] == '\0') {
+    return;
+  }
+
+  auto it = _entries.begin();
+  for (; it != _entries.end(); ++it) {
+    if (it->font == font && it->wrap_width == wrap_width &&
+        same_color(it->color, color) && it->text == text) {
+      break;
+    }
+  }
+
+  if (it == _entries.end()) {
+    // first time this string is seen, it may well change on the next frame
+    _entries.push_front({font, text, color, wrap_width});
+    while (_entries.size() > _capacity) {
+      if (_entries.back().texture != nullptr) {
+        SDL_DestroyTexture(_entries.back().texture);
+      }
+      _entries.pop_back();
+    }
+
+    GlyphAtlas *atlas = get_atlas(renderer, font);
+    if (atlas != nullptr) {
+      render_glyphs(renderer, *atlas, text, color, x, y, wrap_width);
+    }
+    return;
+  }
+
+  _entries.splice(_entries.begin(), _entries, it);
+  Entry &entry = _entries.front();
+
+  if (entry.texture == nullptr && !bake(renderer, entry)) {
+    return;
+  }
+
+  SDL_Rect dst_rect = {x, y, entry.width, entry.height};
+  SDL_RenderCopy(renderer, entry.texture, nullptr, &dst_rect);
+}
+
+TextCache::GlyphAtlas *TextCache::get_atlas(SDL_Renderer *renderer,
+                                            TTF_Font *font) {
+  auto it = _atlases.find(font);
+  if (it != _atlases.end()) {
+    return it->second.texture != nullptr ? &it->second : nullptr;
+  }
+
+  GlyphAtlas &atlas = _atlases[font];
+  atlas.line_height = TTF_FontLineSkip(font);
+
+  const SDL_Color white = {255, 255, 255, 255};
+  SDL_Surface *glyph_surfaces[GLYPH_COUNT] = {};
+
+  // lay the glyphs out in rows before allocating the atlas
+  int x = 0;
+  int y = 0;
+  int row_height = 0;
+  for (int i = 0; i < GLYPH_COUNT; i++) {
+    char glyph[2] = {static_cast<char>(FIRST_GLYPH + i), '\0'};
+    SDL_Surface *surface = TTF_RenderText_Blended(font, glyph, white);
+    glyph_surfaces[i] = surface;
+    if (surface == nullptr) {
+      continue;
+    }
+
+    if (x + surface->w > ATLAS_WIDTH) {
+      x = 0;
+      y += row_height;
+      row_height = 0;
+    }
+
+    atlas.glyphs[i] = {x, y, surface->w, surface->h};
+    x += surface->w;
+    row_height = std::max(row_height, surface->h);
+  }
+
+  SDL_Surface *atlas_surface = SDL_CreateRGBSurfaceWithFormat(
+      0, ATLAS_WIDTH, std::max(y + row_height, 1), 32, SDL_PIXELFORMAT_RGBA32);
+
+  if (atlas_surface != nullptr) {
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+      if (glyph_surfaces[i] == nullptr) {
+        continue;
+      }
+      // copy the coverage as is instead of blending it over nothing
+      SDL_SetSurfaceBlendMode(glyph_surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(glyph_surfaces[i], nullptr, atlas_surface,
+                      &atlas.glyphs[i]);
+    }
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+    atlas.inv_width = 1.f / atlas_surface->w;
+    atlas.inv_height = 1.f / atlas_surface->h;
+    SDL_FreeSurface(atlas_surface);
+  }
+
+  for (SDL_Surface *surface : glyph_surfaces) {
+    if (surface != nullptr) {
+      SDL_FreeSurface(surface);
+    }
+  }
+
+  if (atlas.texture == nullptr) {
+    LoggerManager::log_error("Could not build glyph atlas: " +
+                             std::string(SDL_GetError()));
+    return nullptr;
+  }
+
+  SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+  return &atlas;
+}
+
+void TextCache::render_glyphs(SDL_Renderer *renderer, const GlyphAtlas &atlas,
+                              const char *text, SDL_Color color, int x, int y,
+                              int wrap_width) {
+  _vertices.clear();
+
+  auto glyph_of = [&](char c) -> const SDL_Rect & {
+    if (c < FIRST_GLYPH || c > LAST_GLYPH) {
+      c = '?';
+    }
+    return atlas.glyphs[c - FIRST_GLYPH];
+  };
+
+  int pen_x = 0;
+  int pen_y = 0;
+  size_t length = std::strlen(text);
+
+  for (size_t i = 0; i < length;) {
+    if (text[i] == '\n') {
+      pen_x = 0;
+      pen_y += atlas.line_height;
+      i++;
+      continue;
+    }
+
+    // a word is kept on one line unless it is wider than a whole line
+    size_t word_end = i;
+    int word_width = 0;
+    while (word_end < length && text[word_end] != '\n' &&
+           (word_end == i || text[word_end] != ' ')) {
+      word_width += glyph_of(text[word_end]).w;
+      word_end++;
+    }
+    if (wrap_width > 0 && pen_x > 0 && pen_x + word_width > wrap_width) {
+      pen_x = 0;
+      pen_y += atlas.line_height;
+      // the space the line was broken on is not drawn
+      if (text[i] == ' ') {
+        i++;
+      }
+    }
+
+    for (; i < word_end; i++) {
+      const SDL_Rect &glyph = glyph_of(text[i]);
+      float x0 = static_cast<float>(x + pen_x);
+      float y0 = static_cast<float>(y + pen_y);
+      float x1 = x0 + glyph.w;
+      float y1 = y0 + glyph.h;
+      float u0 = glyph.x * atlas.inv_width;
+      float v0 = glyph.y * atlas.inv_height;
+      float u1 = (glyph.x + glyph.w) * atlas.inv_width;
+      float v1 = (glyph.y + glyph.h) * atlas.inv_height;
+
+      _vertices.push_back({{x0, y0}, color, {u0, v0}});
+      _vertices.push_back({{x1, y0}, color, {u1, v0}});
+      _vertices.push_back({{x1, y1}, color, {u1, v1}});
+      _vertices.push_back({{x0, y1}, color, {u0, v1}});
+      pen_x += glyph.w;
+    }
+  }
+
+  if (_vertices.empty()) {
+    return;
+  }
+
+  // the quad indices never change, only grow the shared buffer when needed
+  size_t quad_count = _vertices.size() / 4;
+  for (size_t quad = _indices.size() / 6; quad < quad_count; quad++) {
+    int first = static_cast<int>(quad * 4);
+    _indices.insert(_indices.end(), {first, first + 1, first + 2, first + 2,
+                                     first + 3, first});
+  }
+
+  SDL_RenderGeometry(renderer, atlas.texture, _vertices.data(),
+                     static_cast<int>(_vertices.size()), _indices.data(),
+                     static_cast<int>(quad_count * 6));
+}
+
+bool TextCache::bake(SDL_Renderer *renderer, Entry &entry) {
+  // blended like the glyph path; a wrap length of 0 still breaks on '\n'
+  SDL_Surface *surface = TTF_RenderText_Blended_Wrapped(
+      entry.font, entry.text.c_str(), entry.color,
+      static_cast<Uint32>(std::max(entry.wrap_width, 0)));
+
+  if (surface == nullptr) {
+    LoggerManager::log_error("Could not render text: " +
+                             std::string(TTF_GetError()));
+    return false;
+  }
+
+  entry.texture = SDL_CreateTextureFromSurface(renderer, surface);
+  entry.width = surface->w;
+  entry.height = surface->h;
+  SDL_FreeSurface(surface);
+
+  if (entry.texture == nullptr) {
+    LoggerManager::log_error("Could not create text texture: " +
+                             std::string(SDL_GetError()));
+    return false;
+  }
+  return true;
+}
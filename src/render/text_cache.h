@@ -0,0 +1,91 @@
+#pragma once
+
+#include <core/config.h>
+
+#include <list>
+
+/**
+ * Text drawing without rasterizing every string on every frame.
+ *
+ * Each font gets a glyph atlas, the printable ASCII characters rasterized
+ * once into a single texture. A string drawn for the first time is laid out
+ * from atlas quads in one SDL_RenderGeometry call. A string drawn again with
+ * the same font, color and wrapping is rasterized into a texture of its own
+ * and copied from then on, the least recently drawn ones are released past
+ * the capacity.
+ *
+ * Fonts are keyed by their TTF_Font, one per file and size as handed out by
+ * AssetManager::get_font. Only to be used from the thread owning the
+ * renderer.
+ */
+class TextCache {
+public:
+  // strings kept as textures
+  static constexpr size_t DEFAULT_CAPACITY = 64;
+
+  TextCache() = default;
+  ~TextCache() { clean(); }
+
+  TextCache(const TextCache &) = delete;
+  TextCache &operator=(const TextCache &) = delete;
+
+  static TextCache *get() {
+    static std::unique_ptr<TextCache> instance = std::make_unique<TextCache>();
+    return instance.get();
+  }
+
+  // release every texture, before the renderer is destroyed
+  void clean();
+
+  /**
+   * Draw a string, with its top left corner at (x, y).
+   * @param wrap_width Lines are broken on spaces past this width, in
+   * pixels, 0 only breaks them on new lines.
+   */
+  void render(SDL_Renderer *renderer, TTF_Font *font, const char *text,
+              SDL_Color color, int x, int y, int wrap_width = 0);
+
+  void set_capacity(size_t capacity) { _capacity = capacity; }
+
+  size_t get_texture_count() const;
+  size_t get_atlas_count() const { return _atlases.size(); }
+
+private:
+  static constexpr char FIRST_GLYPH = ' ';
+  static constexpr char LAST_GLYPH = '~';
+  static constexpr int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+  struct GlyphAtlas {
+    SDL_Texture *texture = nullptr;
+    float inv_width = 0.f;
+    float inv_height = 0.f;
+    int line_height = 0;
+    // the advance of a glyph is the width of its rect
+    SDL_Rect glyphs[GLYPH_COUNT] = {};
+  };
+
+  struct Entry {
+    TTF_Font *font;
+    std::string text;
+    SDL_Color color;
+    int wrap_width;
+    // null until the string is drawn a second time
+    SDL_Texture *texture = nullptr;
+    int width = 0;
+    int height = 0;
+  };
+
+  GlyphAtlas *get_atlas(SDL_Renderer *renderer, TTF_Font *font);
+  void render_glyphs(SDL_Renderer *renderer, const GlyphAtlas &atlas,
+                     const char *text, SDL_Color color, int x, int y,
+                     int wrap_width);
+  bool bake(SDL_Renderer *renderer, Entry &entry);
+
+  std::unordered_map<TTF_Font *, GlyphAtlas> _atlases;
+  // most recently drawn first
+  std::list<Entry> _entries;
+  size_t _capacity = DEFAULT_CAPACITY;
+
+  std::vector<SDL_Vertex> _vertices;
+  std::vector<int> _indices;
+};
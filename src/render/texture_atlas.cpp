@@ -0,0 +1,218 @@
+#include "texture_atlas.h"
+#include <application/application.h>
+
+#include <vector>
+
+namespace {
+
+std::string region_key(const std::string &texture_name, const SDL_Rect &rect) {
+  return texture_name + '#' + std::to_string(rect.x) + ',' +
+         std::to_string(rect.y) + ',' + std::to_string(rect.w) + ',' +
+         std::to_string(rect.h);
+}
+
+} // namespace
+
+bool TextureAtlas::pack(const std::string &texture_name, const SDL_Rect &rect,
+                        AtlasRegion &region) {
+  std::string key = region_key(texture_name, rect);
+  auto it = _regions.find(key);
+  if (it != _regions.end()) {
+    region = it->second;
+    return true;
+  }
+
+  SDL_Surface *sheet = get_sheet(texture_name);
+  if (sheet == nullptr || rect.w <= 0 || rect.h <= 0 || rect.x < 0 ||
+      rect.y < 0 || rect.x + rect.w > sheet->w || rect.y + rect.h > sheet->h) {
+    return false;
+  }
+
+  SDL_Rect bounds = find_opaque_bounds(sheet, rect);
+  if (bounds.w == 0) {
+    // nothing to draw, a single transparent pixel keeps the frame valid
+    bounds = {rect.x, rect.y, 1, 1};
+  }
+
+  Page *page = nullptr;
+  SDL_Rect page_rect;
+  if (!allocate(bounds.w, bounds.h, page, page_rect)) {
+    LoggerManager::log_warning("Frame of " + std::to_string(rect.w) + "x" +
+                               std::to_string(rect.h) + " from " +
+                               texture_name + " does not fit in an atlas page");
+    return false;
+  }
+
+  const uint8_t *pixels = static_cast<const uint8_t *>(sheet->pixels) +
+                          bounds.y * sheet->pitch + bounds.x * 4;
+  SDL_UpdateTexture(page->texture, &page_rect, pixels, sheet->pitch);
+
+  region.texture = page->texture;
+  region.rect = page_rect;
+  region.trim = {bounds.x - rect.x, bounds.y - rect.y, rect.w, rect.h};
+  _regions[key] = region;
+  return true;
+}
+
+void TextureAtlas::release_sheets() {
+  size_t sheet_bytes = 0;
+  for (auto &[name, sheet] : _sheets) {
+    if (sheet != nullptr) {
+      sheet_bytes += static_cast<size_t>(sheet->pitch) * sheet->h;
+      SDL_FreeSurface(sheet);
+      sheet = nullptr;
+    }
+  }
+
+  if (sheet_bytes > 0) {
+    size_t page_bytes =
+        _pages.size() * static_cast<size_t>(_page_size) * _page_size * 4;
+    LoggerManager::log_info(
+        "Packed " + std::to_string(_regions.size()) + " frames into " +
+        std::to_string(_pages.size()) + " atlas pages (" +
+        std::to_string(page_bytes / 1024) + "KB), instead of " +
+        std::to_string(sheet_bytes / 1024) + "KB of sheets");
+  }
+}
+
+void TextureAtlas::clean() {
+  release_sheets();
+  for (auto &page : _pages) {
+    SDL_DestroyTexture(page.texture);
+  }
+  _pages.clear();
+  _regions.clear();
+}
+
+void TextureAtlas::decode_sheets() {
+  for (auto &[texture_name, sheet] : _sheets) {
+    get_sheet(texture_name);
+  }
+}
+
+SDL_Surface *TextureAtlas::get_sheet(const std::string &texture_name) {
+  auto it = _sheets.find(texture_name);
+  if (it == _sheets.end()) {
+    return nullptr;
+  }
+  if (it->second != nullptr) {
+    return it->second;
+  }
+
+  // one known layout to trim and upload from, baked by the texture cache
+  SDL_Surface *surface = AssetManager::load_image(
+      texture_name, AssetDirectory::TEXTURES, SDL_PIXELFORMAT_RGBA32);
+  if (surface == nullptr) {
+    return nullptr;
+  }
+
+  if (surface->format->format == SDL_PIXELFORMAT_RGBA32) {
+    it->second = surface;
+    return it->second;
+  }
+
+  it->second = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(surface);
+  return it->second;
+}
+
+SDL_Rect TextureAtlas::find_opaque_bounds(SDL_Surface *sheet,
+                                          const SDL_Rect &rect) {
+  int min_x = rect.x + rect.w;
+  int min_y = rect.y + rect.h;
+  int max_x = rect.x - 1;
+  int max_y = rect.y - 1;
+
+  const uint8_t *pixels = static_cast<const uint8_t *>(sheet->pixels);
+  for (int y = rect.y; y < rect.y + rect.h; y++) {
+    // the alpha is the last byte of a pixel in RGBA32
+    const uint8_t *alpha = pixels + y * sheet->pitch + rect.x * 4 + 3;
+    for (int x = rect.x; x < rect.x + rect.w; x++, alpha += 4) {
+      if (*alpha != 0) {
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+      }
+    }
+  }
+
+  if (max_x < min_x) {
+    return {0, 0, 0, 0};
+  }
+  return {min_x, min_y, max_x - min_x + 1, max_y - min_y + 1};
+}
+
+bool TextureAtlas::allocate(int width, int height, Page *&page,
+                            SDL_Rect &rect) {
+  int padded_width = width + PADDING * 2;
+  int padded_height = height + PADDING * 2;
+  if (padded_width > _page_size || padded_height > _page_size) {
+    return false;
+  }
+
+  // a new page is only opened once the existing ones are full
+  size_t page_count = _pages.size();
+  for (size_t i = 0; i <= page_count; i++) {
+    Page *candidate = i < _pages.size() ? &_pages[i] : add_page();
+    if (candidate == nullptr) {
+      return false;
+    }
+
+    // the lowest shelf the frame fits in, wasting at most half of its height
+    Shelf *best = nullptr;
+    for (auto &shelf : candidate->shelves) {
+      if (shelf.height >= padded_height &&
+          shelf.height <= padded_height * 2 &&
+          shelf.x + padded_width <= _page_size &&
+          (best == nullptr || shelf.height < best->height)) {
+        best = &shelf;
+      }
+    }
+
+    if (best == nullptr && candidate->bottom + padded_height <= _page_size) {
+      candidate->shelves.push_back({candidate->bottom, padded_height, 0});
+      candidate->bottom += padded_height;
+      best = &candidate->shelves.back();
+    }
+
+    if (best != nullptr) {
+      rect = {best->x + PADDING, best->y + PADDING, width, height};
+      best->x += padded_width;
+      page = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+TextureAtlas::Page *TextureAtlas::add_page() {
+  SDL_Renderer *renderer = Application::get()->get_renderer();
+
+  SDL_RendererInfo info;
+  if (_pages.empty() && SDL_GetRendererInfo(renderer, &info) == 0 &&
+      info.max_texture_width > 0) {
+    _page_size = std::min({_page_size, info.max_texture_width,
+                           info.max_texture_height});
+  }
+
+  SDL_Texture *texture =
+      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                        SDL_TEXTUREACCESS_STATIC, _page_size, _page_size);
+  if (texture == nullptr) {
+    LoggerManager::log_error("Could not create atlas page: " +
+                             std::string(SDL_GetError()));
+    return nullptr;
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+  // static textures start undefined, clear once so padding is transparent
+  std::vector<uint32_t> blank(static_cast<size_t>(_page_size) * _page_size, 0);
+  SDL_UpdateTexture(texture, nullptr, blank.data(),
+                    _page_size * static_cast<int>(sizeof(uint32_t)));
+
+  _pages.emplace_back();
+  _pages.back().texture = texture;
+  return &_pages.back();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <core/config.h>
+
+// where a packed frame ended up
+struct AtlasRegion {
+  SDL_Texture *texture = nullptr;
+  // in page pixels, transparent borders trimmed
+  SDL_Rect rect = {0, 0, 0, 0};
+  // where the trimmed rect lies in the original frame, whose size is w x h
+  SDL_Rect trim = {0, 0, 0, 0};
+};
+
+/**
+ * Pages gathering the frames used by the animations of several sprite
+ * sheets, so that sprites of different sheets share textures and draw calls.
+ * Only the frames packed are uploaded, the sheets themselves never are.
+ *
+ * Frames are packed one by one as their animations are loaded, in rows of
+ * similar heights, with their fully transparent borders trimmed. The sheets
+ * are decoded once and kept in memory until release_sheets().
+ */
+class TextureAtlas {
+public:
+  static constexpr int DEFAULT_PAGE_SIZE = 1024;
+  // empty pixels around every frame, sampling never reaches a neighbor
+  static constexpr int PADDING = 1;
+
+  TextureAtlas() = default;
+  ~TextureAtlas() = default;
+
+  static TextureAtlas *get() {
+    static std::unique_ptr<TextureAtlas> instance =
+        std::make_unique<TextureAtlas>();
+    return instance.get();
+  }
+
+  // serve the frames of a sheet from the atlas, see AnimationLibrary
+  void add_sheet(const std::string &texture_name) {
+    _sheets.emplace(texture_name, nullptr);
+  }
+  bool has_sheet(const std::string &texture_name) const {
+    return _sheets.find(texture_name) != _sheets.end();
+  }
+
+  /**
+   * Pack a frame of a sheet, a frame already packed is only looked up.
+   * @param texture_name A sheet of the textures directory.
+   * @return false if the sheet is not served from the atlas or cannot be
+   * read, the frame keeps sampling the sheet then.
+   */
+  bool pack(const std::string &texture_name, const SDL_Rect &rect,
+            AtlasRegion &region);
+
+  // decode the sheets ahead of packing, safe off the renderer thread while
+  // nothing is packed
+  void decode_sheets();
+  // free the decoded sheets once the animations are loaded
+  void release_sheets();
+  // destroy the pages, the frames packed in them are no longer valid
+  void clean();
+
+  void set_page_size(int page_size) { _page_size = page_size; }
+
+  size_t get_page_count() const { return _pages.size(); }
+  size_t get_region_count() const { return _regions.size(); }
+
+private:
+  struct Shelf {
+    int y;
+    int height;
+    // where the next frame of the shelf goes
+    int x;
+  };
+
+  struct Page {
+    SDL_Texture *texture = nullptr;
+    std::vector<Shelf> shelves;
+    // top of the free space below the shelves
+    int bottom = 0;
+  };
+
+  SDL_Surface *get_sheet(const std::string &texture_name);
+  // bounds of the non transparent pixels of a rect, empty if there are none
+  static SDL_Rect find_opaque_bounds(SDL_Surface *sheet, const SDL_Rect &rect);
+  bool allocate(int width, int height, Page *&page, SDL_Rect &rect);
+  Page *add_page();
+
+  // decoded sheets, null until first used
+  std::map<std::string, SDL_Surface *> _sheets;
+  std::map<std::string, AtlasRegion> _regions;
+  std::vector<Page> _pages;
+  int _page_size = DEFAULT_PAGE_SIZE;
+};
@@ -1,34 +1,51 @@
 #include "sprite.h"
 #include <managers/asset/asset_manager.h>
 #include <managers/logger/logger_manager.h>
+#include <render/texture_atlas.h>
 
 Sprite::Sprite(const char *texture_name, int x, int y, int width, int height,
                float scale) {
-  _texture = AssetManager::get_texture(texture_name);
-  init(x, y, width, height, scale);
+  // the frames of a packed sheet come with their atlas page, the sheet is
+  // never uploaded
+  SDL_Texture *texture = TextureAtlas::get()->has_sheet(texture_name)
+                             ? nullptr
+                             : AssetManager::get_texture(texture_name);
+  init(texture, x, y, width, height, scale);
 }
 
 Sprite::Sprite(SDL_Texture *texture, int x, int y, int width, int height,
                float scale) {
-  _texture = texture;
-  init(x, y, width, height, scale);
+  init(texture, x, y, width, height, scale);
 }
 
-void Sprite::init(int x, int y, int width, int height, float scale) {
-  _src_rect.x = 0;
-  _src_rect.y = 0;
-  _src_rect.w = width;
-  _src_rect.h = height;
-  _dest_rect.x = x;
-  _dest_rect.y = y;
-  _dest_rect.w = width * scale;
-  _dest_rect.h = height * scale;
+Sprite::Sprite(Sprite &&other) noexcept
+    : _id(std::move(other._id)), _handle(other._handle) {
+  other._handle = SpriteHandle();
+}
+
+Sprite &Sprite::operator=(Sprite &&other) noexcept {
+  if (this != &other) {
+    store().destroy(_handle);
+    _id = std::move(other._id);
+    _handle = other._handle;
+    other._handle = SpriteHandle();
+  }
+  return *this;
+}
 
+Sprite::~Sprite() { store().destroy(_handle); }
+
+void Sprite::init(SDL_Texture *texture, int x, int y, int width, int height,
+                  float scale) {
+  _handle = store().create(texture, x, y, width, height, scale);
   _id = UUID::generate_v4_ish();
 }
 
 void Sprite::render(SDL_Renderer *renderer) {
-  if (_texture == nullptr) {
+  size_t i = index();
+  SDL_Texture *texture = store().get_textures()[i];
+
+  if (texture == nullptr) {
     LoggerManager::log_error("Could not render sprite, texture is null");
     return;
   }
@@ -38,13 +55,12 @@ void Sprite::render(SDL_Renderer *renderer) {
     return;
   }
 
-  if (!_animation_controller.get_current_animation().empty()) {
-    _src_rect = _animation_controller.get_current_frame().rect;
-  }
+  store().sync_source_rect(i);
 
-  SDL_RenderCopy(renderer, _texture, &_src_rect, &_dest_rect);
+  SDL_RenderCopy(renderer, texture, &store().get_src_rects()[i],
+                 &store().get_dest_rects()[i]);
 }
 
-void Sprite::update(double delta_time) {
-  _animation_controller.update(delta_time);
-}
\ No newline at end of file
+// animations and velocities are advanced in batch by SpriteStore::update,
+// this is only a hook for gameplay logic
+void Sprite::update(double /*delta_time*/) {}
@@ -1,11 +1,17 @@
 #pragma once
 
+#include "sprite_store.h"
 #include <animation/animation_controller.h>
 #include <core/config.h>
 #include <core/enums.h>
 #include <structs/my_vector.h>
 #include <utils/uuid.h>
 
+/**
+ * Thin handle over a sprite living in the SpriteStore. The sprite data is
+ * released from the store when the handle is destroyed, so a Sprite can be
+ * moved but not copied.
+ */
 class Sprite {
 public:
   Sprite() = default;
@@ -13,97 +19,130 @@ public:
          float scale = 1);
   Sprite(SDL_Texture *texture, int x, int y, int width, int height,
          float scale = 1);
-  virtual ~Sprite() = default;
+  Sprite(const Sprite &) = delete;
+  Sprite &operator=(const Sprite &) = delete;
+  Sprite(Sprite &&other) noexcept;
+  Sprite &operator=(Sprite &&other) noexcept;
+  virtual ~Sprite();
 
   virtual void render(SDL_Renderer *renderer);
   virtual void update(double delta_time);
 
-  void set_direction(Direction direction) { _direction = direction; }
+  void set_direction(Direction direction) {
+    store().get_directions()[index()] = direction;
+  }
   virtual void move(float x, float y) {
-    _dest_rect.x += x;
-    _dest_rect.y += y;
+    const Vector2f &position = store().get_positions()[index()];
+    store().set_position(index(), position.x + x, position.y + y);
   }
 
-  void set_position(int x, int y) {
-    _dest_rect.x = x;
-    _dest_rect.y = y;
-  }
+  // placing a sprite is not a movement, it is not drawn sliding there
+  void set_position(int x, int y) { store().teleport(index(), x, y); }
 
   template <typename T> void set_position(const Vector2<T> &position) {
-    _dest_rect.x = position.x;
-    _dest_rect.y = position.y;
+    store().teleport(index(), position.x, position.y);
   }
 
   void set_size(int width, int height) {
-    _dest_rect.w = width * _scale;
-    _dest_rect.h = height * _scale;
+    size_t i = index();
+    SDL_Rect &dest_rect = store().get_dest_rects()[i];
+    dest_rect.w = width * get_scale();
+    dest_rect.h = height * get_scale();
+    store().sync_bounds(i);
   }
 
   template <typename T> void set_size(const Vector2<T> &size) {
-    _dest_rect.w = size.x * _scale;
-    _dest_rect.h = size.y * _scale;
+    set_size(size.x, size.y);
   }
 
   void set_scale(float scale) {
-    _scale = scale;
-    _dest_rect.w = _src_rect.w * _scale;
-    _dest_rect.h = _src_rect.h * _scale;
+    size_t i = index();
+    store().get_scales()[i] = scale;
+    store().get_dest_rects()[i].w = store().get_src_rects()[i].w * scale;
+    store().get_dest_rects()[i].h = store().get_src_rects()[i].h * scale;
+    store().sync_bounds(i);
   }
 
   void set_source_rect(int x, int y, int width, int height) {
-    _src_rect.x = x;
-    _src_rect.y = y;
-    _src_rect.w = width;
-    _src_rect.h = height;
+    store().get_src_rects()[index()] = {x, y, width, height};
+  }
+
+  void set_velocity(const Vector2f &velocity) {
+    store().get_velocities()[index()] = velocity;
   }
 
+  void set_z_index(int z_index) { store().set_z_index(index(), z_index); }
+
   const std::string &get_id() const { return _id; }
+  SpriteHandle get_handle() const { return _handle; }
 
-  const SDL_Rect &get_src_rect() const { return _src_rect; }
-  const SDL_Rect &get_dest_rect() const { return _dest_rect; }
+  const SDL_Rect &get_src_rect() const {
+    return store().get_src_rects()[index()];
+  }
+  const SDL_Rect &get_dest_rect() const {
+    return store().get_dest_rects()[index()];
+  }
+  const Vector2f &get_position() const {
+    return store().get_positions()[index()];
+  }
+  const Vector2f &get_velocity() const {
+    return store().get_velocities()[index()];
+  }
 
-  const Direction &get_direction() const { return _direction; }
+  Direction get_direction() const {
+    return store().get_directions()[index()];
+  }
 
-  const float &get_scale() const { return _scale; }
+  float get_scale() const { return store().get_scales()[index()]; }
 
+  // the reference is invalidated when sprites are created or destroyed
   AnimationController &get_animation_controller() {
-    return _animation_controller;
+    return store().get_animations()[index()];
+  }
+
+  // cheap, only the shared set handle and the playback cursor are copied
+  void
+  attach_animation_controller(const AnimationController &animation_controller) {
+    get_animation_controller() = animation_controller;
   }
-  void attach_animation_controller(AnimationController &animation_controller) {
-    _animation_controller = animation_controller;
+  void attach_animations(std::shared_ptr<const AnimationSet> animations) {
+    get_animation_controller().set_animations(std::move(animations));
   }
 
   friend std::ostream &operator<<(std::ostream &os, const Sprite &sprite) {
     // print the class like a json object, deconstruct the rects
     // pretty print it with correct spacing
+    const SDL_Rect &src_rect = sprite.get_src_rect();
+    const SDL_Rect &dest_rect = sprite.get_dest_rect();
+
     os << "{\n";
     os << "  \"id\": \"" << sprite._id << "\",\n";
-    os << "  \"texture\": \"" << sprite._texture << "\",\n";
+    os << "  \"texture\": \""
+       << store().get_textures()[sprite.index()] << "\",\n";
     os << "  \"src_rect\": {\n";
-    os << "    \"x\": " << sprite._src_rect.x << ",\n";
-    os << "    \"y\": " << sprite._src_rect.y << ",\n";
-    os << "    \"w\": " << sprite._src_rect.w << ",\n";
-    os << "    \"h\": " << sprite._src_rect.h << "\n";
+    os << "    \"x\": " << src_rect.x << ",\n";
+    os << "    \"y\": " << src_rect.y << ",\n";
+    os << "    \"w\": " << src_rect.w << ",\n";
+    os << "    \"h\": " << src_rect.h << "\n";
     os << "  },\n";
     os << "  \"dest_rect\": {\n";
-    os << "    \"x\": " << sprite._dest_rect.x << ",\n";
-    os << "    \"y\": " << sprite._dest_rect.y << ",\n";
-    os << "    \"w\": " << sprite._dest_rect.w << ",\n";
-    os << "    \"h\": " << sprite._dest_rect.h << "\n";
+    os << "    \"x\": " << dest_rect.x << ",\n";
+    os << "    \"y\": " << dest_rect.y << ",\n";
+    os << "    \"w\": " << dest_rect.w << ",\n";
+    os << "    \"h\": " << dest_rect.h << "\n";
     os << "  },\n";
-    os << "  \"scale\": " << sprite._scale << "\n";
+    os << "  \"scale\": " << sprite.get_scale() << "\n";
     os << "}\n";
     return os;
   }
 
 protected:
   std::string _id;
-  Direction _direction = Direction::DOWN;
-  AnimationController _animation_controller;
-  SDL_Texture *_texture = nullptr;
-  SDL_Rect _src_rect;
-  SDL_Rect _dest_rect;
-  float _scale = 1;
-
-  void init(int x, int y, int width, int height, float scale);
-};
\ No newline at end of file
+  SpriteHandle _handle;
+
+  static SpriteStore &store() { return *SpriteStore::get(); }
+  size_t index() const { return store().index_of(_handle); }
+
+  void init(SDL_Texture *texture, int x, int y, int width, int height,
+            float scale);
+};
@@ -0,0 +1,84 @@
+#include "sprite_batch.h"
+#include <managers/logger/logger_manager.h>
+
+void SpriteBatch::begin(SDL_Renderer *renderer) {
+  _renderer = renderer;
+  _texture = nullptr;
+  _vertices.clear();
+  _draw_calls = 0;
+  _sprites = 0;
+}
+
+void SpriteBatch::draw(SDL_Texture *texture, const SDL_Rect &src_rect,
+                       const SDL_Rect &dst_rect, bool flipped) {
+  if (texture != _texture) {
+    flush();
+
+    int width = 0;
+    int height = 0;
+    if (SDL_QueryTexture(texture, nullptr, nullptr, &width, &height) != 0 ||
+        width == 0 || height == 0) {
+      LoggerManager::log_error("Could not query texture: " +
+                               std::string(SDL_GetError()));
+      _texture = nullptr;
+      return;
+    }
+
+    _texture = texture;
+    _inv_texture_width = 1.f / width;
+    _inv_texture_height = 1.f / height;
+  }
+
+  float u0 = src_rect.x * _inv_texture_width;
+  float v0 = src_rect.y * _inv_texture_height;
+  float u1 = (src_rect.x + src_rect.w) * _inv_texture_width;
+  float v1 = (src_rect.y + src_rect.h) * _inv_texture_height;
+
+  if (flipped) {
+    std::swap(u0, u1);
+  }
+
+  float x0 = dst_rect.x;
+  float y0 = dst_rect.y;
+  float x1 = dst_rect.x + dst_rect.w;
+  float y1 = dst_rect.y + dst_rect.h;
+
+  const SDL_Color white = {255, 255, 255, 255};
+
+  _vertices.push_back({{x0, y0}, white, {u0, v0}});
+  _vertices.push_back({{x1, y0}, white, {u1, v0}});
+  _vertices.push_back({{x1, y1}, white, {u1, v1}});
+  _vertices.push_back({{x0, y1}, white, {u0, v1}});
+
+  _sprites++;
+}
+
+void SpriteBatch::end() {
+  flush();
+  _renderer = nullptr;
+}
+
+void SpriteBatch::flush() {
+  if (_vertices.empty() || _texture == nullptr) {
+    _vertices.clear();
+    return;
+  }
+
+  // the quad indices never change, only grow the shared buffer when needed
+  size_t quad_count = _vertices.size() / 4;
+  for (size_t quad = _indices.size() / 6; quad < quad_count; quad++) {
+    int first = static_cast<int>(quad * 4);
+    _indices.insert(_indices.end(), {first, first + 1, first + 2, first + 2,
+                                     first + 3, first});
+  }
+
+  if (SDL_RenderGeometry(_renderer, _texture, _vertices.data(),
+                         static_cast<int>(_vertices.size()), _indices.data(),
+                         static_cast<int>(quad_count * 6)) != 0) {
+    LoggerManager::log_error("SDL_RenderGeometry Error: " +
+                             std::string(SDL_GetError()));
+  }
+
+  _draw_calls++;
+  _vertices.clear();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <core/config.h>
+
+/**
+ * Accumulates textured quads and submits them with one SDL_RenderGeometry
+ * call per run of sprites sharing the same texture. The vertex and index
+ * buffers are reused from one frame to the next.
+ */
+class SpriteBatch {
+public:
+  SpriteBatch() = default;
+  ~SpriteBatch() = default;
+
+  void begin(SDL_Renderer *renderer);
+
+  /**
+   * Queue a quad, flushing the pending ones first if the texture changed.
+   * @param texture The texture to sample.
+   * @param src_rect The region of the texture, in pixels.
+   * @param dst_rect The destination on screen, in pixels.
+   * @param flipped Whether to mirror the quad horizontally.
+   */
+  void draw(SDL_Texture *texture, const SDL_Rect &src_rect,
+            const SDL_Rect &dst_rect, bool flipped = false);
+
+  void end();
+
+  size_t get_draw_call_count() const { return _draw_calls; }
+  size_t get_sprite_count() const { return _sprites; }
+
+private:
+  void flush();
+
+  SDL_Renderer *_renderer = nullptr;
+  SDL_Texture *_texture = nullptr;
+  float _inv_texture_width = 0.f;
+  float _inv_texture_height = 0.f;
+
+  std::vector<SDL_Vertex> _vertices;
+  std::vector<int> _indices;
+
+  size_t _draw_calls = 0;
+  size_t _sprites = 0;
+};
@@ -0,0 +1,267 @@
+#include "sprite_store.h"
+#include <jobs/job_system.h>
+#include <managers/logger/logger_manager.h>
+
+SpriteHandle SpriteStore::create(SDL_Texture *texture, int x, int y,
+                                 int width, int height, float scale) {
+  uint32_t slot;
+  if (!_free_slots.empty()) {
+    slot = _free_slots.back();
+    _free_slots.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(_generations.size());
+    _generations.push_back(0);
+    _dense_indices.push_back(0);
+  }
+
+  uint32_t index = static_cast<uint32_t>(size());
+  _dense_indices[slot] = index;
+  _slots.push_back(slot);
+
+  _positions.emplace_back(static_cast<float>(x), static_cast<float>(y));
+  _previous_positions.push_back(_positions.back());
+  _velocities.emplace_back(0.f, 0.f);
+  _src_rects.push_back({0, 0, width, height});
+  _dest_rects.push_back({x, y, static_cast<int>(width * scale),
+                         static_cast<int>(height * scale)});
+  _animations.emplace_back();
+  _textures.push_back(texture);
+  _flipped.push_back(false);
+  _trims.push_back({0, 0, 0, 0});
+  _pending_times.push_back(0.f);
+  _scales.push_back(scale);
+  _directions.push_back(Direction::DOWN);
+  _z_indices.push_back(0);
+
+  _spatial_hash.insert(slot, _dest_rects.back());
+
+  _render_order_dirty = true;
+
+  return {slot, _generations[slot]};
+}
+
+void SpriteStore::destroy(SpriteHandle handle) {
+  if (!is_valid(handle)) {
+    return;
+  }
+
+  size_t index = _dense_indices[handle.slot];
+  size_t last = size() - 1;
+
+  // move the last sprite into the hole to keep the arrays packed
+  if (index != last) {
+    _positions[index] = _positions[last];
+    _previous_positions[index] = _previous_positions[last];
+    _velocities[index] = _velocities[last];
+    _src_rects[index] = _src_rects[last];
+    _dest_rects[index] = _dest_rects[last];
+    _animations[index] = std::move(_animations[last]);
+    _textures[index] = _textures[last];
+    _flipped[index] = _flipped[last];
+    _trims[index] = _trims[last];
+    _pending_times[index] = _pending_times[last];
+    _scales[index] = _scales[last];
+    _directions[index] = _directions[last];
+    _z_indices[index] = _z_indices[last];
+
+    _slots[index] = _slots[last];
+    _dense_indices[_slots[index]] = index;
+  }
+
+  _positions.pop_back();
+  _previous_positions.pop_back();
+  _velocities.pop_back();
+  _src_rects.pop_back();
+  _dest_rects.pop_back();
+  _animations.pop_back();
+  _textures.pop_back();
+  _flipped.pop_back();
+  _trims.pop_back();
+  _pending_times.pop_back();
+  _scales.pop_back();
+  _directions.pop_back();
+  _z_indices.pop_back();
+  _slots.pop_back();
+
+  _spatial_hash.remove(handle.slot);
+
+  // invalidate every handle still pointing to this slot
+  _generations[handle.slot]++;
+  _free_slots.push_back(handle.slot);
+
+  _render_order_dirty = true;
+}
+
+void SpriteStore::clear() {
+  for (uint32_t slot : _slots) {
+    _generations[slot]++;
+    _free_slots.push_back(slot);
+  }
+
+  _positions.clear();
+  _previous_positions.clear();
+  _velocities.clear();
+  _src_rects.clear();
+  _dest_rects.clear();
+  _animations.clear();
+  _textures.clear();
+  _flipped.clear();
+  _trims.clear();
+  _pending_times.clear();
+  _scales.clear();
+  _directions.clear();
+  _z_indices.clear();
+  _slots.clear();
+
+  _spatial_hash.clear();
+
+  _render_order.clear();
+  _render_order_dirty = true;
+}
+
+void SpriteStore::update(double delta_time, const Camera *camera) {
+  size_t count = size();
+
+  // a sprite only touches its own entries of the arrays, the chunks are
+  // independent
+  JobSystem::get()->parallel_for(
+      count, UPDATE_CHUNK_SIZE, [&](size_t begin, size_t end) {
+        update_range(begin, end, delta_time, camera);
+      });
+
+  // the spatial hash is shared, the moved sprites are put back in it here
+  for (size_t i = 0; i < count; i++) {
+    const Vector2f &velocity = _velocities[i];
+    if (velocity.x != 0 || velocity.y != 0) {
+      _spatial_hash.update(_slots[i], _dest_rects[i]);
+    }
+  }
+}
+
+void SpriteStore::update_range(size_t begin, size_t end, double delta_time,
+                               const Camera *camera) {
+  float dt = static_cast<float>(delta_time);
+
+  for (size_t i = begin; i < end; i++) {
+    const Vector2f &velocity = _velocities[i];
+    if (velocity.x == 0 && velocity.y == 0) {
+      continue;
+    }
+
+    Vector2f &position = _positions[i];
+    position.x += velocity.x * dt;
+    position.y += velocity.y * dt;
+    _dest_rects[i].x = static_cast<int>(position.x);
+    _dest_rects[i].y = static_cast<int>(position.y);
+  }
+
+  if (camera == nullptr) {
+    for (size_t i = begin; i < end; i++) {
+      AnimationController::advance(_animations[i].get_cursor(), delta_time);
+    }
+
+    for (size_t i = begin; i < end; i++) {
+      sync_source_rect(i);
+    }
+    return;
+  }
+
+  for (size_t i = begin; i < end; i++) {
+    if (!camera->is_visible(_dest_rects[i])) {
+      _pending_times[i] += dt;
+      continue;
+    }
+
+    AnimationController::advance(_animations[i].get_cursor(),
+                                 delta_time + _pending_times[i]);
+    _pending_times[i] = 0.f;
+    sync_source_rect(i);
+  }
+}
+
+void SpriteStore::render(DrawList &draw_list, const Camera &camera,
+                         float alpha) {
+  for (uint32_t index : get_render_order()) {
+    SDL_Rect dest_rect = _dest_rects[index];
+    const Vector2f &previous = _previous_positions[index];
+    const Vector2f &current = _positions[index];
+    if (previous.x != current.x || previous.y != current.y) {
+      dest_rect.x =
+          static_cast<int>(previous.x + (current.x - previous.x) * alpha);
+      dest_rect.y =
+          static_cast<int>(previous.y + (current.y - previous.y) * alpha);
+    }
+
+    if (_textures[index] == nullptr || !camera.is_visible(dest_rect)) {
+      continue;
+    }
+
+    // a trimmed frame only covers part of the untrimmed one
+    const SDL_Rect &trim = _trims[index];
+    if (trim.w != 0 && trim.h != 0) {
+      const SDL_Rect &src_rect = _src_rects[index];
+      float scale_x = static_cast<float>(dest_rect.w) / trim.w;
+      float scale_y = static_cast<float>(dest_rect.h) / trim.h;
+      int offset_x =
+          _flipped[index] ? trim.w - trim.x - src_rect.w : trim.x;
+
+      dest_rect.x += static_cast<int>(offset_x * scale_x);
+      dest_rect.y += static_cast<int>(trim.y * scale_y);
+      dest_rect.w = static_cast<int>(src_rect.w * scale_x);
+      dest_rect.h = static_cast<int>(src_rect.h * scale_y);
+    }
+
+    draw_list.sprite(_textures[index], _src_rects[index],
+                     camera.world_to_screen(dest_rect), _flipped[index]);
+  }
+}
+
+void SpriteStore::query_rect(const SDL_Rect &rect,
+                             std::vector<SpriteHandle> &out) {
+  _spatial_hash.query_rect(rect, _query_slots);
+  append_handles(out);
+}
+
+void SpriteStore::query_radius(const Vector2f &center, float radius,
+                               std::vector<SpriteHandle> &out) {
+  _spatial_hash.query_radius(center, radius, _query_slots);
+  append_handles(out);
+}
+
+void SpriteStore::query_point(const Vector2f &point,
+                              std::vector<SpriteHandle> &out) {
+  _spatial_hash.query_point(point, _query_slots);
+  append_handles(out);
+}
+
+void SpriteStore::append_handles(std::vector<SpriteHandle> &out) {
+  for (uint32_t slot : _query_slots) {
+    out.push_back({slot, _generations[slot]});
+  }
+  _query_slots.clear();
+}
+
+const std::vector<uint32_t> &SpriteStore::get_render_order() {
+  if (!_render_order_dirty) {
+    return _render_order;
+  }
+
+  _render_order.resize(size());
+  for (uint32_t i = 0; i < _render_order.size(); i++) {
+    _render_order[i] = i;
+  }
+
+  // group by texture inside a z layer to get the longest batches, the dense
+  // order is the creation order until a sprite gets destroyed
+  std::stable_sort(_render_order.begin(), _render_order.end(),
+                   [this](uint32_t a, uint32_t b) {
+                     if (_z_indices[a] != _z_indices[b]) {
+                       return _z_indices[a] < _z_indices[b];
+                     }
+                     return std::less<SDL_Texture *>()(_textures[a],
+                                                       _textures[b]);
+                   });
+
+  _render_order_dirty = false;
+  return _render_order;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <animation/animation_controller.h>
+#include <camera/camera.h>
+#include <core/config.h>
+#include <core/enums.h>
+#include <render/draw_list.h>
+#include <structs/my_vector.h>
+#include <structs/spatial_hash.h>
+
+#include <atomic>
+
+// Stable reference to a sprite of the SpriteStore, survives other sprites
+// being created or destroyed.
+struct SpriteHandle {
+  static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+  uint32_t slot = INVALID_SLOT;
+  uint32_t generation = 0;
+
+  bool operator==(const SpriteHandle &other) const {
+    return slot == other.slot && generation == other.generation;
+  }
+  bool operator!=(const SpriteHandle &other) const { return !(*this == other); }
+};
+
+/**
+ * Owns the data of every sprite in contiguous structure-of-arrays buffers so
+ * that animations, movement and rendering run as tight loops over packed
+ * arrays. Sprite objects are thin handles into this store.
+ *
+ * The arrays are dense: destroying a sprite moves the last one into its
+ * place, so dense indices (and references into the arrays) are only valid
+ * until the next create/destroy. Use handles to keep track of a sprite.
+ */
+class SpriteStore {
+public:
+  SpriteStore() = default;
+  ~SpriteStore() = default;
+
+  static SpriteStore *get() {
+    static std::unique_ptr<SpriteStore> instance =
+        std::make_unique<SpriteStore>();
+    return instance.get();
+  }
+
+  SpriteHandle create(SDL_Texture *texture, int x, int y, int width,
+                      int height, float scale = 1);
+  void destroy(SpriteHandle handle);
+  void clear();
+
+  bool is_valid(SpriteHandle handle) const {
+    return handle.slot < _generations.size() &&
+           _generations[handle.slot] == handle.generation;
+  }
+
+  // dense index of a live sprite
+  size_t index_of(SpriteHandle handle) const {
+    assert(is_valid(handle));
+    return _dense_indices[handle.slot];
+  }
+
+  size_t size() const { return _positions.size(); }
+
+  /**
+   * Move every sprite by its velocity and advance all the animations.
+   * @param delta_time The elapsed time in seconds.
+   * @param camera When given, the animations of the sprites out of its view
+   * are not advanced, the elapsed time is kept and caught up on once they
+   * come back into view.
+   *
+   * The sprites are updated in parallel chunks on the JobSystem, the frame
+   * callbacks of the animations may run on any of its threads.
+   */
+  void update(double delta_time, const Camera *camera = nullptr);
+
+  // remember where the sprites are, to call before each simulation step so
+  // that rendering can blend between the last two steps
+  void save_previous_positions() { _previous_positions = _positions; }
+
+  /**
+   * Record the sprites visible by the camera, ordered by z index then texture
+   * so that sprites sharing a texture end up in the same batched draw call
+   * once the list is replayed.
+   * @param draw_list The list to record into.
+   * @param camera The view to render, off-screen sprites are skipped.
+   * @param alpha Where to draw the sprites between their previous and current
+   * positions, 1 draws them where they are.
+   */
+  void render(DrawList &draw_list, const Camera &camera, float alpha = 1.f);
+
+  // per sprite helpers working on a dense index
+  void set_position(size_t index, float x, float y) {
+    _positions[index] = {x, y};
+    _dest_rects[index].x = static_cast<int>(x);
+    _dest_rects[index].y = static_cast<int>(y);
+    sync_bounds(index);
+  }
+
+  // move a sprite without it being drawn sliding from where it was
+  void teleport(size_t index, float x, float y) {
+    set_position(index, x, y);
+    _previous_positions[index] = _positions[index];
+  }
+
+  // to call after changing a destination rect directly
+  void sync_bounds(size_t index) {
+    _spatial_hash.update(_slots[index], _dest_rects[index]);
+  }
+
+  void set_texture(size_t index, SDL_Texture *texture) {
+    _textures[index] = texture;
+    _render_order_dirty = true;
+  }
+
+  void set_z_index(size_t index, int z_index) {
+    _z_indices[index] = z_index;
+    _render_order_dirty = true;
+  }
+
+  // refresh the source rect of a sprite from its animation frame, and its
+  // texture when the frame was packed into an atlas page
+  void sync_source_rect(size_t index) {
+    const AnimationCursor &cursor = _animations[index].get_cursor();
+    if (cursor.has_clip()) {
+      const Frame &frame = cursor.get_frame();
+      _src_rects[index] = frame.rect;
+      _flipped[index] = frame.flipped;
+      _trims[index] = frame.trim;
+
+      if (frame.texture != nullptr && frame.texture != _textures[index]) {
+        _textures[index] = frame.texture;
+        _render_order_dirty = true;
+      }
+    }
+  }
+
+  // getters for the raw arrays, indexed by dense index
+  std::vector<Vector2f> &get_positions() { return _positions; }
+  std::vector<Vector2f> &get_velocities() { return _velocities; }
+  std::vector<SDL_Rect> &get_src_rects() { return _src_rects; }
+  std::vector<SDL_Rect> &get_dest_rects() { return _dest_rects; }
+  std::vector<AnimationController> &get_animations() { return _animations; }
+  std::vector<SDL_Texture *> &get_textures() { return _textures; }
+  std::vector<uint8_t> &get_flipped() { return _flipped; }
+  std::vector<float> &get_scales() { return _scales; }
+  std::vector<Direction> &get_directions() { return _directions; }
+  std::vector<int> &get_z_indices() { return _z_indices; }
+
+  /**
+   * Spatial queries over the destination rects, in world pixels. The results
+   * are appended to `out`.
+   */
+  void query_rect(const SDL_Rect &rect, std::vector<SpriteHandle> &out);
+  void query_radius(const Vector2f &center, float radius,
+                    std::vector<SpriteHandle> &out);
+  void query_point(const Vector2f &point, std::vector<SpriteHandle> &out);
+
+  // match the spatial hash cells to the tile grid
+  void set_cell_size(int cell_size) { _spatial_hash.set_cell_size(cell_size); }
+
+  // dense indices sorted by z index then texture, rebuilt lazily
+  const std::vector<uint32_t> &get_render_order();
+
+private:
+  // sprites updated by a single job
+  static constexpr size_t UPDATE_CHUNK_SIZE = 512;
+
+  // move and animate the sprites of [begin, end), safe to run concurrently
+  // on disjoint ranges
+  void update_range(size_t begin, size_t end, double delta_time,
+                    const Camera *camera);
+
+  // hot data, touched every frame
+  std::vector<Vector2f> _positions;
+  std::vector<Vector2f> _previous_positions; // before the last step
+  std::vector<Vector2f> _velocities;
+  std::vector<SDL_Rect> _src_rects;
+  std::vector<SDL_Rect> _dest_rects;
+  std::vector<AnimationController> _animations;
+  std::vector<SDL_Texture *> _textures;
+  std::vector<uint8_t> _flipped;
+  std::vector<SDL_Rect> _trims; // see Frame::trim
+  std::vector<float> _pending_times; // animation time owed to hidden sprites
+
+  // cold data
+  std::vector<float> _scales;
+  std::vector<Direction> _directions;
+  std::vector<int> _z_indices;
+
+  // handle bookkeeping
+  std::vector<uint32_t> _dense_indices; // slot -> dense index
+  std::vector<uint32_t> _slots;         // dense index -> slot
+  std::vector<uint32_t> _generations;   // slot -> generation
+  std::vector<uint32_t> _free_slots;
+
+  std::vector<uint32_t> _render_order;
+  // set from the parallel update when a frame switches atlas pages
+  std::atomic<bool> _render_order_dirty = true;
+
+  SpatialHash _spatial_hash; // indexed by slot
+  std::vector<uint32_t> _query_slots;
+
+  void append_handles(std::vector<SpriteHandle> &out);
+};
@@ -2,7 +2,6 @@
 #include <managers/input/input_manager.h>
 #include <utils/enums_utils.h>
 #include <utils/math_utils.h>
-#include <utils/string_utils.h>
 
 Trainer::Trainer(const char *texture_name, int x, int y, int width, int height,
                  float scale)
@@ -33,34 +32,58 @@ void Trainer::update(double delta_time) {
   if (player_direction != Direction::NONE)
     set_direction(player_direction);
 
-  std::string animation_prefix =
-      input_direction.magnitude() > 0.1f
-          ? InputManager::is_key_down(SDLK_LSHIFT) ? "run_" : "walk_"
-          : "idle_";
+  bool is_moving = input_direction.magnitude() > 0.1f;
+  bool is_running = InputManager::is_key_down(SDLK_LSHIFT);
 
-  float speed = InputManager::is_key_down(SDLK_LSHIFT) ? 250.f : 150.f;
+  MovementState state = is_moving ? is_running ? MovementState::RUN
+                                               : MovementState::WALK
+                                  : MovementState::IDLE;
 
-  if (_riding_bike) {
-    if (animation_prefix == "idle_")
-      animation_prefix = "bike_idle_";
-    else
-      animation_prefix = "bike_";
+  float speed = is_running ? 250.f : 150.f;
 
+  if (_riding_bike) {
+    state = is_moving ? MovementState::BIKE : MovementState::BIKE_IDLE;
     speed = 500.f;
   }
 
-  if (input_direction.magnitude() > 0.1f) {
-
+  if (is_moving) {
     get_animation_controller().play_animation(
-        animation_prefix +
-        StringUtils::to_lower(
-            InputManager::direction_to_string(player_direction)));
+        get_animation_id(state, player_direction));
 
     move(input_direction.x * delta_time * speed,
          input_direction.y * delta_time * speed);
   } else {
     get_animation_controller().play_animation(
-        animation_prefix +
-        StringUtils::to_lower(InputManager::direction_to_string(_direction)));
+        get_animation_id(state, get_direction()));
   }
 }
+
+const Trainer::AnimationTable &Trainer::get_animation_table() {
+  static const AnimationTable table = [] {
+    const char *prefixes[] = {"idle_", "walk_", "run_", "bike_idle_", "bike_"};
+    const char *directions[] = {"up", "down", "left", "right"};
+
+    AnimationTable table;
+    for (size_t state = 0; state < table.size(); state++) {
+      for (size_t direction = 0; direction < table[state].size();
+           direction++) {
+        table[state][direction] = AnimationIds::intern(
+            std::string(prefixes[state]) + directions[direction]);
+      }
+    }
+    return table;
+  }();
+
+  return table;
+}
+
+AnimationId Trainer::get_animation_id(MovementState state,
+                                      Direction direction) {
+  if (direction == Direction::NONE || state == MovementState::COUNT) {
+    return StringInterner::INVALID_ID;
+  }
+
+  // Direction::NONE is not part of the table
+  return get_animation_table()[static_cast<size_t>(state)]
+                              [static_cast<size_t>(direction) - 1];
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sprite.h"
+#include <array>
 
 class Trainer : public Sprite {
 public:
@@ -13,6 +14,15 @@ public:
   void set_name(const std::string &name) { _name = name; }
   const std::string &get_name() const { return _name; }
 
+  // animation ids indexed by movement state then direction, interned once
+  using AnimationTable =
+      std::array<std::array<AnimationId, 4>,
+                 static_cast<size_t>(MovementState::COUNT)>;
+
+  static const AnimationTable &get_animation_table();
+  static AnimationId get_animation_id(MovementState state,
+                                      Direction direction);
+
   void toggle_bike() { _riding_bike = !_riding_bike; }
   void mount_bike() { _riding_bike = true; }
   void dismount_bike() { _riding_bike = false; }
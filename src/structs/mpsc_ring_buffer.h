@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Bounded queue for many producers and a single consumer, without locks.
+ * Every cell carries a sequence number telling whether it is free for the
+ * producer of a given position or filled for the consumer, producers only
+ * race on the tail with a compare and swap. Pushing to a full queue fails
+ * instead of waiting.
+ */
+template <typename T> class MpscRingBuffer {
+public:
+  // rounded up to a power of two
+  explicit MpscRingBuffer(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+
+    _mask = size - 1;
+    _cells = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; i++) {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(const MpscRingBuffer &) = delete;
+  MpscRingBuffer &operator=(const MpscRingBuffer &) = delete;
+
+  size_t capacity() const { return _mask + 1; }
+
+  // from any thread, false when the queue is full
+  bool try_push(T &&value) {
+    size_t position = _tail.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    while (true) {
+      cell = &_cells[position & _mask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+      if (difference == 0) {
+        // the cell is free, claim the position
+        if (_tail.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // the consumer has not freed the cell of the previous lap
+        return false;
+      } else {
+        position = _tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // from the consumer thread only, false when the queue is empty
+  bool try_pop(T &value) {
+    Cell &cell = _cells[_head & _mask];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence != _head + 1) {
+      return false;
+    }
+
+    value = std::move(cell.value);
+    // free for the producer of the next lap
+    cell.sequence.store(_head + _mask + 1, std::memory_order_release);
+    _head++;
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> _cells;
+  size_t _mask = 0;
+
+  // on their own cache lines, the producers hammer the tail
+  alignas(64) std::atomic<size_t> _tail = 0;
+  alignas(64) size_t _head = 0;
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <core/config.h>
+#include <structs/my_vector.h>
+
+/**
+ * Uniform grid bucketing rects by the cells they overlap. Items are
+ * identified by small integer ids (e.g. sprite slots) so that their entry can
+ * be found in O(1) when they move; an item is only re-bucketed when the range
+ * of cells it covers changes.
+ */
+class SpatialHash {
+public:
+  explicit SpatialHash(int cell_size = DEFAULT_TILE_SIZE)
+      : _cell_size(std::max(cell_size, 1)) {}
+
+  int get_cell_size() const { return _cell_size; }
+  size_t get_cell_count() const { return _cells.size(); }
+
+  // change the cell size, re-bucketing every item
+  void set_cell_size(int cell_size) {
+    _cell_size = std::max(cell_size, 1);
+    _cells.clear();
+    for (uint32_t id = 0; id < _entries.size(); id++) {
+      Entry &entry = _entries[id];
+      if (entry.active) {
+        entry.cells = get_cell_range(entry.rect);
+        add_to_cells(id, entry.cells);
+      }
+    }
+  }
+
+  void insert(uint32_t id, const SDL_Rect &rect) {
+    if (id >= _entries.size()) {
+      _entries.resize(id + 1);
+      _query_stamps.resize(id + 1, 0);
+    }
+
+    Entry &entry = _entries[id];
+    if (entry.active) {
+      update(id, rect);
+      return;
+    }
+
+    entry.active = true;
+    entry.rect = rect;
+    entry.cells = get_cell_range(rect);
+    add_to_cells(id, entry.cells);
+  }
+
+  void update(uint32_t id, const SDL_Rect &rect) {
+    if (id >= _entries.size() || !_entries[id].active) {
+      insert(id, rect);
+      return;
+    }
+
+    Entry &entry = _entries[id];
+    entry.rect = rect;
+
+    CellRange cells = get_cell_range(rect);
+    if (cells == entry.cells) {
+      return;
+    }
+
+    remove_from_cells(id, entry.cells);
+    entry.cells = cells;
+    add_to_cells(id, entry.cells);
+  }
+
+  void remove(uint32_t id) {
+    if (id >= _entries.size() || !_entries[id].active) {
+      return;
+    }
+
+    remove_from_cells(id, _entries[id].cells);
+    _entries[id].active = false;
+  }
+
+  void clear() {
+    _cells.clear();
+    _entries.clear();
+    _query_stamps.clear();
+  }
+
+  /**
+   * Call `callback(id)` once for every item whose rect overlaps `rect`.
+   */
+  template <typename F> void query_rect(const SDL_Rect &rect, F &&callback) {
+    uint32_t stamp = next_stamp();
+    CellRange cells = get_cell_range(rect);
+
+    for (int cy = cells.min_y; cy <= cells.max_y; cy++) {
+      for (int cx = cells.min_x; cx <= cells.max_x; cx++) {
+        auto it = _cells.find(make_key(cx, cy));
+        if (it == _cells.end()) {
+          continue;
+        }
+
+        for (uint32_t id : it->second) {
+          if (_query_stamps[id] == stamp) {
+            continue;
+          }
+          _query_stamps[id] = stamp;
+
+          if (intersects(_entries[id].rect, rect)) {
+            callback(id);
+          }
+        }
+      }
+    }
+  }
+
+  void query_rect(const SDL_Rect &rect, std::vector<uint32_t> &out) {
+    query_rect(rect, [&out](uint32_t id) { out.push_back(id); });
+  }
+
+  void query_radius(const Vector2f &center, float radius,
+                    std::vector<uint32_t> &out) {
+    SDL_Rect bounds = {static_cast<int>(std::floor(center.x - radius)),
+                       static_cast<int>(std::floor(center.y - radius)),
+                       static_cast<int>(std::ceil(radius * 2)) + 1,
+                       static_cast<int>(std::ceil(radius * 2)) + 1};
+
+    float radius_squared = radius * radius;
+    query_rect(bounds, [&](uint32_t id) {
+      // distance from the center to the closest point of the rect
+      const SDL_Rect &rect = _entries[id].rect;
+      float dx = center.x - std::clamp(center.x, static_cast<float>(rect.x),
+                                       static_cast<float>(rect.x + rect.w));
+      float dy = center.y - std::clamp(center.y, static_cast<float>(rect.y),
+                                       static_cast<float>(rect.y + rect.h));
+      if (dx * dx + dy * dy <= radius_squared) {
+        out.push_back(id);
+      }
+    });
+  }
+
+  void query_point(const Vector2f &point, std::vector<uint32_t> &out) {
+    SDL_Rect bounds = {static_cast<int>(std::floor(point.x)),
+                       static_cast<int>(std::floor(point.y)), 1, 1};
+    query_rect(bounds, out);
+  }
+
+private:
+  struct CellRange {
+    int min_x = 0;
+    int min_y = 0;
+    int max_x = -1;
+    int max_y = -1;
+
+    bool operator==(const CellRange &other) const {
+      return min_x == other.min_x && min_y == other.min_y &&
+             max_x == other.max_x && max_y == other.max_y;
+    }
+  };
+
+  struct Entry {
+    SDL_Rect rect = {0, 0, 0, 0};
+    CellRange cells;
+    bool active = false;
+  };
+
+  static bool intersects(const SDL_Rect &a, const SDL_Rect &b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h &&
+           b.y < a.y + a.h;
+  }
+
+  // shifted as unsigned, shifting a negative cell is undefined
+  static uint64_t make_key(int cx, int cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+           static_cast<uint32_t>(cy);
+  }
+
+  int to_cell(int coordinate) const {
+    // floor division so that negative coordinates land in negative cells
+    return coordinate >= 0 ? coordinate / _cell_size
+                           : -((-coordinate - 1) / _cell_size) - 1;
+  }
+
+  CellRange get_cell_range(const SDL_Rect &rect) const {
+    return {to_cell(rect.x), to_cell(rect.y),
+            to_cell(rect.x + std::max(rect.w, 1) - 1),
+            to_cell(rect.y + std::max(rect.h, 1) - 1)};
+  }
+
+  void add_to_cells(uint32_t id, const CellRange &cells) {
+    for (int cy = cells.min_y; cy <= cells.max_y; cy++) {
+      for (int cx = cells.min_x; cx <= cells.max_x; cx++) {
+        _cells[make_key(cx, cy)].push_back(id);
+      }
+    }
+  }
+
+  void remove_from_cells(uint32_t id, const CellRange &cells) {
+    for (int cy = cells.min_y; cy <= cells.max_y; cy++) {
+      for (int cx = cells.min_x; cx <= cells.max_x; cx++) {
+        auto it = _cells.find(make_key(cx, cy));
+        if (it == _cells.end()) {
+          continue;
+        }
+
+        std::vector<uint32_t> &ids = it->second;
+        auto id_it = std::find(ids.begin(), ids.end(), id);
+        if (id_it != ids.end()) {
+          *id_it = ids.back();
+          ids.pop_back();
+        }
+
+        // the cells a sprite walked through would pile up otherwise
+        if (ids.empty()) {
+          _cells.erase(it);
+        }
+      }
+    }
+  }
+
+  uint32_t next_stamp() {
+    if (++_query_stamp == 0) {
+      // wrapped around, reset the stamps so no stale one matches
+      std::fill(_query_stamps.begin(), _query_stamps.end(), 0);
+      _query_stamp = 1;
+    }
+    return _query_stamp;
+  }
+
+  int _cell_size;
+  std::unordered_map<uint64_t, std::vector<uint32_t>> _cells;
+  std::vector<Entry> _entries;
+
+  std::vector<uint32_t> _query_stamps;
+  uint32_t _query_stamp = 0;
+};
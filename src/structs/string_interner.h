@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Maps strings to small stable integer ids, id 0 is reserved for "no string".
+class StringInterner {
+public:
+  using Id = uint32_t;
+  static constexpr Id INVALID_ID = 0;
+
+  StringInterner() = default;
+  StringInterner(const StringInterner &) = delete;
+  ~StringInterner() = default;
+
+  // get the id of the string, registering it if it is not known yet
+  Id intern(const std::string &str) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _ids.find(str);
+    if (it != _ids.end()) {
+      return it->second;
+    }
+
+    _strings.push_back(str);
+    Id id = static_cast<Id>(_strings.size());
+    _ids.emplace(str, id);
+    return id;
+  }
+
+  // get the id of an already interned string, INVALID_ID otherwise
+  Id find(const std::string &str) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _ids.find(str);
+    return it != _ids.end() ? it->second : INVALID_ID;
+  }
+
+  const std::string &lookup(Id id) const {
+    static const std::string empty;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (id == INVALID_ID || id > _strings.size()) {
+      return empty;
+    }
+    // deque elements never move, the reference outlives the lock
+    return _strings[id - 1];
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _strings.size();
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::deque<std::string> _strings;
+  std::unordered_map<std::string, Id> _ids;
+};
@@ -1,5 +1,6 @@
 #include "render_utils.h"
 #include <application/application.h>
+#include <render/text_cache.h>
 
 namespace RenderUtils {
 
@@ -55,38 +56,10 @@ void render_text(SDL_Renderer *renderer, TTF_Font *font, const char *text,
     exit(EXIT_FAILURE);
   }
 
-  SDL_Surface *surface = nullptr;
-  if (wrap) {
-    surface = TTF_RenderText_Blended_Wrapped(font, text, color, 200);
-  } else {
-    surface = TTF_RenderText_Solid(font, text, color);
-  }
-
-  if (surface == nullptr) {
-    LoggerManager::log_error("SDL_Surface is null");
-    std::cerr << "SDL_Surface is null" << std::endl;
-    exit(EXIT_FAILURE);
-  }
-
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-
-  if (texture == nullptr) {
-    LoggerManager::log_error("SDL_Texture is null");
-    std::cerr << "SDL_Texture is null" << std::endl;
-    exit(EXIT_FAILURE);
-  }
-
-  SDL_Rect dst_rect;
-
-  dst_rect.x = x;
-  dst_rect.y = y;
-  dst_rect.w = surface->w;
-  dst_rect.h = surface->h;
-
-  SDL_RenderCopy(renderer, texture, nullptr, &dst_rect);
-
-  SDL_FreeSurface(surface);
-  SDL_DestroyTexture(texture);
+  // unchanged strings are drawn from a cached texture, the others from the
+  // glyph atlas of the font
+  TextCache::get()->render(renderer, font, text, color, x, y,
+                           wrap ? TEXT_WRAP_WIDTH : 0);
 }
 
 void render_grid(SDL_Renderer *renderer, int width, int height, int tile_size,
@@ -5,6 +5,9 @@
 
 namespace RenderUtils {
 
+// width past which wrapped text is broken into lines, in pixels
+constexpr int TEXT_WRAP_WIDTH = 200;
+
 void render_texture(SDL_Renderer *renderer, SDL_Texture *texture,
                     SDL_Rect src_rect, SDL_Rect dst_rect, bool repeat = false);
 